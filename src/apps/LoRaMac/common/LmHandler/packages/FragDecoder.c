@@ -22,6 +22,7 @@
  */
 #include <stddef.h>
 #include <stdbool.h>
+#include <string.h>
 #include "utilities.h"
 #include "FragDecoder.h"
 
@@ -41,6 +42,60 @@
     #define DBG( fmt, ... )
 #endif
 
+/*!
+ * Number of 32 bits words required to store a bit array of nbBits
+ */
+#define BIT_ARRAY_NB_WORDS( nbBits )                ( ( ( nbBits ) + 31 ) >> 5 )
+
+/*!
+ * Number of 32 bits words of the triangular binary matrix able to recover
+ * maxNbLost fragments. One extra word allows unaligned word accesses on the
+ * last row.
+ */
+#if( FRAG_DECODER_MATRIX_IN_STORAGE == 0 )
+#define MATRIX_M2B_NB_WORDS( maxNbLost )            ( ( uint32_t )BIT_ARRAY_NB_WORDS( ( ( maxNbLost ) * ( ( maxNbLost ) + 1 ) ) >> 1 ) + 1 )
+#else
+#define MATRIX_M2B_NB_WORDS( maxNbLost )            ( ( uint32_t )0 )
+#endif
+
+/*!
+ * Number of 32 bits words of the missing fragments map covered by one entry
+ * of the rank table
+ */
+#define MISSING_FRAGS_BLOCK_NB_WORDS                8
+
+/*!
+ * Number of entries of the missing fragments rank table
+ */
+#define MISSING_FRAGS_NB_BLOCKS( fragNb )           ( ( BIT_ARRAY_NB_WORDS( fragNb ) + MISSING_FRAGS_BLOCK_NB_WORDS - 1 ) / MISSING_FRAGS_BLOCK_NB_WORDS )
+
+/*!
+ * Number of 32 bits words of the workspace of a session
+ */
+#define SESSION_WORKSPACE_NB_WORDS( fragNb, maxNbLost )                                                 \
+    ( BIT_ARRAY_NB_WORDS( fragNb ) + ( ( MISSING_FRAGS_NB_BLOCKS( fragNb ) + 1 ) >> 1 ) +             \
+      BIT_ARRAY_NB_WORDS( maxNbLost ) + MATRIX_M2B_NB_WORDS( maxNbLost ) )
+
+/*!
+ * Number of 32 bits words of the workspace arena
+ */
+#if( FRAG_DECODER_ARENA_SIZE == 0 )
+#define ARENA_NB_WORDS                              ( FRAG_DECODER_MAX_SESSIONS * SESSION_WORKSPACE_NB_WORDS( FRAG_MAX_NB, FRAG_MAX_REDUNDANCY ) )
+#else
+#define ARENA_NB_WORDS                              ( ( FRAG_DECODER_ARENA_SIZE ) >> 2 )
+#endif
+
+#if( FRAG_DECODER_MATRIX_IN_STORAGE == 1 ) && ( FRAG_DECODER_FILE_HANDLING_NEW_API != 1 )
+    #error "FRAG_DECODER_MATRIX_IN_STORAGE requires FRAG_DECODER_FILE_HANDLING_NEW_API"
+#endif
+
+#if( FRAG_DECODER_CACHE_NB_PAGES > 0 ) && ( FRAG_DECODER_FILE_HANDLING_NEW_API != 1 )
+    #error "FRAG_DECODER_CACHE_NB_PAGES requires FRAG_DECODER_FILE_HANDLING_NEW_API"
+#endif
+
+#if( FRAG_DECODER_MAX_SESSIONS > 1 ) && ( FRAG_DECODER_FILE_HANDLING_NEW_API != 1 )
+    #error "FRAG_DECODER_MAX_SESSIONS greater than 1 requires FRAG_DECODER_FILE_HANDLING_NEW_API"
+#endif
 
 /*
  *=============================================================================
@@ -48,35 +103,131 @@
  *=============================================================================
  */
 
+#if( FRAG_DECODER_CACHE_NB_PAGES > 0 )
+/*!
+ * Write-back cache page
+ */
+typedef struct sFragCachePage
+{
+    /*!
+     * Storage address of the page
+     */
+    uint32_t Addr;
+    /*!
+     * Cache access counter value at the last access. Used to evict the least
+     * recently used page
+     */
+    uint32_t LastUse;
+    /*!
+     * Set when the page holds data
+     */
+    bool Valid;
+    /*!
+     * Set when the page data differs from the storage
+     */
+    bool Dirty;
+    uint8_t Data[FRAG_DECODER_CACHE_PAGE_MAX_SIZE];
+}FragCachePage_t;
+#endif
+
 typedef struct
 {
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
     FragDecoderCallbacks_t *Callbacks;
+    /*!
+     * Size of the storage area used by the session ( file and matrix )
+     */
+    uint32_t StorageSize;
+#if( FRAG_DECODER_CACHE_NB_PAGES > 0 )
+    FragCachePage_t CachePages[FRAG_DECODER_CACHE_NB_PAGES];
+    uint32_t CacheAccessCounter;
+#endif
 #else
     uint8_t *File;
     uint32_t FileSize;
 #endif
     uint16_t FragNb;
     uint8_t FragSize;
+    /*!
+     * Maximum number of lost fragments that can be recovered
+     */
+    uint16_t MaxNbLost;
+    /*!
+     * Session workspace taken from the arena. NULL when the session is not
+     * initialized
+     */
+    uint32_t *Workspace;
+    uint32_t WorkspaceNbWords;
+    /*!
+     * Modulo used to draw the parity matrix rows coefficients and its
+     * reciprocal floor( ( 2^32 - 1 ) / ParityRowModulo )
+     */
+    uint32_t ParityRowModulo;
+    uint32_t ParityRowReciprocal;
 
     uint32_t M2BLine;
-    uint8_t MatrixM2B[( ( FRAG_MAX_REDUNDANCY >> 3 ) + 1 ) * FRAG_MAX_REDUNDANCY];
-    uint16_t FragNbMissingIndex[FRAG_MAX_NB];
+    /*!
+     * Number of data lines XORed while processing the current fragment
+     */
+    uint32_t NbDataLineXor;
+#if( FRAG_DECODER_MATRIX_IN_STORAGE == 0 )
+    /*!
+     * Upper triangular binary matrix
+     */
+    uint32_t *MatrixM2B;
+#endif
+    /*!
+     * Missing fragments map. A bit set to 1 marks a lost fragment.
+     */
+    uint32_t *MissingFrags;
+    /*!
+     * Number of lost fragments preceding each block of
+     * MISSING_FRAGS_BLOCK_NB_WORDS words of the missing fragments map.
+     */
+    uint16_t *MissingFragsRank;
 
-    uint8_t S[( FRAG_MAX_REDUNDANCY >> 3 ) + 1];
+    uint32_t *S;
 
     FragDecoderStatus_t Status;
 }FragDecoder_t;
 
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
+/*!
+ * \brief Writes data to the storage, through the cache when enabled
+ *
+ * \param [IN] decoder Decoding session
+ * \param [IN] addr Storage address
+ * \param [IN] data Data buffer to be written
+ * \param [IN] size Number of bytes to be written
+ */
+static void StorageWrite( FragDecoder_t *decoder, uint32_t addr, uint8_t *data, uint32_t size );
+
+/*!
+ * \brief Reads data from the storage, through the cache when enabled
+ *
+ * \param [IN] decoder Decoding session
+ * \param [IN] addr Storage address
+ * \param [IN] data Data buffer to be filled
+ * \param [IN] size Number of bytes to be read
+ */
+static void StorageRead( FragDecoder_t *decoder, uint32_t addr, uint8_t *data, uint32_t size );
+
+/*!
+ * \brief Writes back all the modified cached pages to the storage
+ *
+ * \param [IN] decoder Decoding session
+ */
+static void StorageFlush( FragDecoder_t *decoder );
+
 /*!
  * \brief Sets a row from source into file destination
  *
+ * \param [IN] decoder Decoding session
  * \param [IN] src  Source buffer pointer
  * \param [IN] row  Destination index of the row to be copied
  * \param [IN] size Source number of bytes to be copied
  */
-static void SetRow( uint8_t *src, uint16_t row, uint16_t size );
+static void SetRow( FragDecoder_t *decoder, uint8_t *src, uint16_t row, uint16_t size );
 #else
 /*!
  * \brief Sets a row from source into destination
@@ -93,11 +244,12 @@ static void SetRow( uint8_t *dst, uint8_t *src, uint16_t row, uint16_t size );
 /*!
  * \brief Gets a row from source and stores it into file destination
  *
+ * \param [IN] decoder Decoding session
  * \param [IN] src  Source buffer pointer
  * \param [IN] row  Source index of the row to be copied
  * \param [IN] size Source number of bytes to be copied
  */
-static void GetRow( uint8_t *src, uint16_t row, uint16_t size );
+static void GetRow( FragDecoder_t *decoder, uint8_t *src, uint16_t row, uint16_t size );
 #else
 /*!
  * \brief Gets a row from source and stores it into destination
@@ -118,7 +270,7 @@ static void GetRow( uint8_t *dst, uint8_t *src, uint16_t row, uint16_t size );
  *
  * \retval parity         Parity value at the given index
  */
-static uint8_t GetParity( uint16_t index, uint8_t *matrixRow  );
+static uint8_t GetParity( uint16_t index, uint32_t *matrixRow  );
 
 /*!
  * \brief Sets the parity value on the given row of the parity matrix
@@ -127,7 +279,59 @@ static uint8_t GetParity( uint16_t index, uint8_t *matrixRow  );
  * \param [IN/OUT] matrixRow Pointer to the parity matrix.
  * \param [IN]     parity    The parity value to be set in the parity matrix
  */
-static void SetParity( uint16_t index, uint8_t *matrixRow, uint8_t parity );
+static void SetParity( uint16_t index, uint32_t *matrixRow, uint8_t parity );
+
+/*!
+ * \brief Counts the number of trailing zeros of a 32 bits word
+ *
+ * \param [IN] x  Value to be tested. Must be different from 0
+ *
+ * \retval count  Index of the least significant bit set
+ */
+static uint8_t CountTrailingZeros( uint32_t x );
+
+/*!
+ * \brief Counts the number of bits set in a 32 bits word
+ *
+ * \param [IN] x  Value to be tested
+ *
+ * \retval count  Number of bits set
+ */
+static uint8_t BitCount( uint32_t x );
+
+#if( FRAG_DECODER_MATRIX_IN_STORAGE == 0 )
+/*!
+ * \brief Reads 32 consecutive bits of a bit array starting at any bit offset
+ *
+ * \param [IN] bitArray Pointer to the bit array
+ * \param [IN] offset   Index of the first bit to be read
+ *
+ * \retval word         Read bits. Bit 0 holds the bit at the given offset
+ */
+static uint32_t BitArrayGetWord( uint32_t *bitArray, uint32_t offset );
+
+/*!
+ * \brief Writes up to 32 consecutive bits of a bit array starting at any bit offset
+ *
+ * \param [IN/OUT] bitArray Pointer to the bit array
+ * \param [IN]     offset   Index of the first bit to be written
+ * \param [IN]     word     Bits to be written. Bit 0 is written at the given offset
+ * \param [IN]     mask     Mask of the bits of word to be written
+ */
+static void BitArraySetWord( uint32_t *bitArray, uint32_t offset, uint32_t word, uint32_t mask );
+#endif
+
+/*!
+ * \brief Computes the mask of the bits of the word wordIndex which are
+ *        part of the range [first, last[
+ *
+ * \param [IN] wordIndex Word index
+ * \param [IN] first     Index of the first bit of the range
+ * \param [IN] last      Index following the last bit of the range
+ *
+ * \retval mask          Bits mask
+ */
+static uint32_t BitArrayRangeMask( uint16_t wordIndex, uint16_t first, uint16_t last );
 
 /*!
  * \brief Check if the provided value is a power of 2
@@ -141,13 +345,95 @@ static bool IsPowerOfTwo( uint32_t x );
 /*!
  * \brief XOrs two data lines
  *
+ * \param [IN] decoder Decoding session
  * \param [IN]  line1  1st Data line to be XORed
  * \param [IN]  line2  2nd Data line to be XORed
  * \param [IN]  size   Number of elements in line1
  *
  * \param [OUT] result XOR( line1, line2 ) result stored in line1
  */
-static void XorDataLine( uint8_t *line1, uint8_t *line2, int32_t size );
+static void XorDataLine( FragDecoder_t *decoder, uint8_t *line1, uint8_t *line2, int32_t size );
+
+/*!
+ * \brief Takes a workspace from the arena
+ *
+ * \param [IN] nbWords Workspace size in 32 bits words
+ *
+ * \retval workspace   Pointer to the workspace. NULL if not enough memory
+ */
+static uint32_t* FragArenaAlloc( uint32_t nbWords );
+
+/*!
+ * \brief Takes the workspace of a session from the arena. The session is left
+ *        untouched when the allocation fails
+ *
+ * \param [IN] decoder    Decoding session
+ * \param [IN] fragNb     Number of expected fragments (without redundancy packets)
+ * \param [IN] fragSize   Size of a fragment
+ *
+ * \retval status         [0: Success, -1: Not enough memory]
+ */
+static int8_t FragWorkspaceAlloc( FragDecoder_t *decoder, uint16_t fragNb, uint8_t fragSize );
+
+/*!
+ * \brief Initializes the current session. The workspace must have been
+ *        allocated by \ref FragWorkspaceAlloc
+ *
+ * \param [IN] decoder    Decoding session
+ * \param [IN] fragNb     Number of expected fragments (without redundancy packets)
+ * \param [IN] fragSize   Size of a fragment
+ */
+static void FragInit( FragDecoder_t *decoder, uint16_t fragNb, uint8_t fragSize );
+
+/*!
+ * \brief Processes a received fragment of the current session and updates
+ *        its statistics. See \ref FragDecoderProcess
+ *
+ * \param [IN] decoder     Decoding session
+ * \param [IN] fragCounter Fragment counter
+ * \param [IN] rawData     Pointer to the fragment to be processed
+ *
+ * \retval status          Process status
+ */
+static int32_t FragSessionProcess( FragDecoder_t *decoder, uint16_t fragCounter, uint8_t *rawData );
+
+/*!
+ * \brief Processes a received fragment. See \ref FragDecoderProcess
+ *
+ * \param [IN] decoder     Decoding session
+ * \param [IN] fragCounter Fragment counter
+ * \param [IN] rawData     Pointer to the fragment to be processed
+ *
+ * \retval status          Process status
+ */
+static int32_t FragProcess( FragDecoder_t *decoder, uint16_t fragCounter, uint8_t *rawData );
+
+#if( FRAG_DECODER_ONLINE_ELIMINATION == 1 )
+/*!
+ * \brief Clears the bits of a new binary matrix line located in the pivot
+ *        columns of the already stored lines
+ *
+ * \param [IN] decoder      Decoding session
+ * \param [IN/OUT] line     New line whose first one is pivot
+ * \param [IN]     pivot    Pivot column of the new line
+ * \param [IN/OUT] data     Data associated to the new line
+ * \param [IN]     lineTemp Temporary line buffer
+ * \param [IN]     dataTemp Temporary data buffer
+ */
+static void FragReduceLine( FragDecoder_t *decoder, uint32_t *line, uint16_t pivot, uint8_t *data, uint32_t *lineTemp, uint8_t *dataTemp );
+
+/*!
+ * \brief Clears the pivot column of a new line from the already stored lines
+ *
+ * \param [IN] decoder      Decoding session
+ * \param [IN]     line     New line, already reduced
+ * \param [IN]     pivot    Pivot column of the new line
+ * \param [IN]     data     Data associated to the new line
+ * \param [IN]     lineTemp Temporary line buffer
+ * \param [IN]     dataTemp Temporary data buffer
+ */
+static void FragEliminateColumn( FragDecoder_t *decoder, uint32_t *line, uint16_t pivot, uint8_t *data, uint32_t *lineTemp, uint8_t *dataTemp );
+#endif
 
 /*!
  * \brief XORs two parity lines
@@ -158,7 +444,7 @@ static void XorDataLine( uint8_t *line1, uint8_t *line2, int32_t size );
  *
  * \param [OUT] result XOR( line1, line2 ) result stored in line1
  */
-static void XorParityLine( uint8_t* line1, uint8_t* line2, int32_t size );
+static void XorParityLine( uint32_t* line1, uint32_t* line2, int32_t size );
 
 /*!
  * \brief Generates a pseudo random number : PRBS23
@@ -172,11 +458,12 @@ static int32_t FragPrbs23( int32_t value );
 /*!
  * \brief Gets and fills the parity matrix
  *
+ * \param [IN] decoder    Decoding session
  * \param [IN]  n         Fragment N
  * \param [IN]  m         Fragment number
  * \param [OUT] matrixRow Parity matrix
  */
-static void FragGetParityMatrixRow( int32_t n, int32_t m, uint8_t *matrixRow );
+static void FragGetParityMatrixRow( FragDecoder_t *decoder, int32_t n, int32_t m, uint32_t *matrixRow );
 
 /*!
  * \brief Finds the index of the first one in a bit array
@@ -185,7 +472,7 @@ static void FragGetParityMatrixRow( int32_t n, int32_t m, uint8_t *matrixRow );
  * \param [IN] size     Bit array size
  * \retval index        The index of the first 1 in the bit array
  */
-static uint16_t BitArrayFindFirstOne( uint8_t *bitArray, uint16_t size );
+static uint16_t BitArrayFindFirstOne( uint32_t *bitArray, uint16_t size );
 
 /*!
  * \brief Checks if the provided bit array only contains zeros
@@ -194,42 +481,64 @@ static uint16_t BitArrayFindFirstOne( uint8_t *bitArray, uint16_t size );
  * \param [IN] size     Bit array size
  * \retval isAllZeros   [0: Contains ones, 1: Contains all zeros]
  */
-static uint8_t BitArrayIsAllZeros( uint8_t *bitArray, uint16_t  size );
+static uint8_t BitArrayIsAllZeros( uint32_t *bitArray, uint16_t  size );
 
 /*!
  * \brief Finds & marks missing fragments
  *
+ * \param [IN] decoder  Decoding session
  * \param [IN]  counter Current fragment counter
- * \param [OUT] FragDecoder.FragNbMissingIndex[] array is updated in place
+ * \param [OUT] FragDecoder.MissingFrags[] map is updated in place
  */
-static void FragFindMissingFrags( uint16_t counter );
+static void FragFindMissingFrags( FragDecoder_t *decoder, uint16_t counter );
+
+/*!
+ * \brief Builds the missing fragments rank table once the missing fragments
+ *        map is final
+ *
+ * \param [IN] decoder Decoding session
+ */
+static void FragBuildMissingFragsRank( FragDecoder_t *decoder );
+
+/*!
+ * \brief Gets the number of lost fragments preceding the given fragment
+ *
+ * \param [IN] decoder Decoding session
+ * \param [IN] index Fragment index
+ *
+ * \retval rank      Number of lost fragments before index
+ */
+static uint16_t FragGetMissingFragRank( FragDecoder_t *decoder, uint16_t index );
 
 /*!
  * \brief Finds the index (frag counter) of the x th missing frag
  *
+ * \param [IN] decoder Decoding session
  * \param [IN] x   x th missing frag
  *
  * \retval counter The counter value associated to the x th missing frag
  */
-static uint16_t FragFindMissingIndex( uint16_t x );
+static uint16_t FragFindMissingIndex( FragDecoder_t *decoder, uint16_t x );
 
 /*!
  * \brief Extacts a row from the binary matrix and expands it to a bitArray
  *
+ * \param [IN] decoder   Decoding session
  * \param [IN] bitArray  Pointer to the bit array
  * \param [IN] rowIndex  Matrix row index
  * \param [IN] bitsInRow Number of bits in one row
  */
-static void FragExtractLineFromBinaryMatrix( uint8_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow );
+static void FragExtractLineFromBinaryMatrix( FragDecoder_t *decoder, uint32_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow );
 
 /*!
  * \brief Collapses and Pushs a row of a bit array to the matrix
  *
+ * \param [IN] decoder   Decoding session
  * \param [IN] bitArray  Pointer to the bit array
  * \param [IN] rowIndex  Matrix row index
  * \param [IN] bitsInRow Number of bits in one row
  */
-static void FragPushLineToBinaryMatrix( uint8_t *bitArray, uint16_t rowIndex, uint16_t bitsInRow );
+static void FragPushLineToBinaryMatrix( FragDecoder_t *decoder, uint32_t *bitArray, uint16_t rowIndex, uint16_t bitsInRow );
 
 /*
  *=============================================================================
@@ -237,58 +546,147 @@ static void FragPushLineToBinaryMatrix( uint8_t *bitArray, uint16_t rowIndex, ui
  *=============================================================================
  */
 
-static FragDecoder_t FragDecoder;
+static uint32_t FragArena[ARENA_NB_WORDS];
+
+static FragDecoder_t FragDecoders[FRAG_DECODER_MAX_SESSIONS];
 
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
 void FragDecoderInit( uint16_t fragNb, uint8_t fragSize, FragDecoderCallbacks_t *callbacks )
+{
+    FragDecoderSessionInit( 0, fragNb, fragSize, callbacks );
+}
+
+int8_t FragDecoderSessionInit( uint8_t sessionId, uint16_t fragNb, uint8_t fragSize, FragDecoderCallbacks_t *callbacks )
+{
+    FragDecoder_t *decoder;
+
+    if( sessionId >= FRAG_DECODER_MAX_SESSIONS )
+    {
+        return -1;
+    }
+    decoder = &FragDecoders[sessionId];
+    // The ongoing session is kept when the new one can't be allocated
+    if( FragWorkspaceAlloc( decoder, fragNb, fragSize ) != 0 )
+    {
+        return -1;
+    }
+    decoder->Callbacks = callbacks;
+    decoder->StorageSize = ( uint32_t )fragNb * fragSize;
+#if( FRAG_DECODER_MATRIX_IN_STORAGE == 1 )
+    decoder->StorageSize += FRAG_MATRIX_STORAGE_SIZE;
+#endif
+    decoder->Status.StorageNbReads = 0;
+    decoder->Status.StorageNbWrites = 0;
+#if( FRAG_DECODER_CACHE_NB_PAGES > 0 )
+    for( uint8_t i = 0; i < FRAG_DECODER_CACHE_NB_PAGES; i++ )
+    {
+        decoder->CachePages[i].Valid = false;
+        decoder->CachePages[i].Dirty = false;
+    }
+    decoder->CacheAccessCounter = 0;
+#endif
+    FragInit( decoder, fragNb, fragSize );
+    return 0;
+}
 #else
 void FragDecoderInit( uint16_t fragNb, uint8_t fragSize, uint8_t *file, uint32_t fileSize )
-#endif
 {
-#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-    FragDecoder.Callbacks = callbacks;
-#else
-    FragDecoder.File = file;
-    FragDecoder.FileSize = fileSize;
-#endif
-    FragDecoder.FragNb = fragNb;                                // FragNb = FRAG_MAX_SIZE
-    FragDecoder.FragSize = fragSize;                            // number of byte on a row
-    FragDecoder.Status.FragNbLastRx = 0;
-    FragDecoder.Status.FragNbLost = 0;
-    FragDecoder.M2BLine = 0;
+    FragDecoder_t *decoder = &FragDecoders[0];
 
-    // Initialize missing fragments index array
-    for( uint16_t i = 0; i < FRAG_MAX_NB; i++ )
+    decoder->Workspace = NULL;
+    decoder->File = file;
+    decoder->FileSize = fileSize;
+    if( FragWorkspaceAlloc( decoder, fragNb, fragSize ) == 0 )
     {
-        FragDecoder.FragNbMissingIndex[i] = 1;
+        FragInit( decoder, fragNb, fragSize );
     }
+}
+#endif
+
+static int8_t FragWorkspaceAlloc( FragDecoder_t *decoder, uint16_t fragNb, uint8_t fragSize )
+{
+    uint32_t *previous = decoder->Workspace;
+    uint32_t *workspace;
+    uint16_t maxNbLost;
+    uint32_t nbWords;
 
-    // Initialize parity matrix
-    for( uint32_t i = 0; i < ( ( FRAG_MAX_REDUNDANCY >> 3 ) + 1 ); i++ )
+    if( ( fragNb > FRAG_MAX_NB ) || ( fragSize > FRAG_MAX_SIZE ) )
     {
-        FragDecoder.S[i] = 0;
+        return -1;
     }
+    // A session can't loose more fragments than it holds
+    maxNbLost = ( fragNb < FRAG_MAX_REDUNDANCY ) ? fragNb : FRAG_MAX_REDUNDANCY;
+    nbWords = SESSION_WORKSPACE_NB_WORDS( fragNb, maxNbLost );
+
+    // The workspace of the session being replaced can be reused
+    decoder->Workspace = NULL;
+    workspace = FragArenaAlloc( nbWords );
+    if( workspace == NULL )
+    {
+        decoder->Workspace = previous;
+        return -1;
+    }
+    decoder->Workspace = workspace;
+    decoder->WorkspaceNbWords = nbWords;
+    decoder->MaxNbLost = maxNbLost;
+    return 0;
+}
+
+static void FragInit( FragDecoder_t *decoder, uint16_t fragNb, uint8_t fragSize )
+{
+    uint32_t *workspace = decoder->Workspace;
+
+    decoder->MissingFrags = workspace;
+    workspace += BIT_ARRAY_NB_WORDS( fragNb );
+    decoder->MissingFragsRank = ( uint16_t* )workspace;
+    workspace += ( MISSING_FRAGS_NB_BLOCKS( fragNb ) + 1 ) >> 1;
+    decoder->S = workspace;
+#if( FRAG_DECODER_MATRIX_IN_STORAGE == 0 )
+    workspace += BIT_ARRAY_NB_WORDS( decoder->MaxNbLost );
+    decoder->MatrixM2B = workspace;
+#endif
 
-    for( uint32_t i = 0; i < ( ( ( FRAG_MAX_REDUNDANCY >> 3 ) + 1 ) * FRAG_MAX_REDUNDANCY ); i++ )
+    decoder->FragNb = fragNb;                                // FragNb = FRAG_MAX_SIZE
+    decoder->FragSize = fragSize;                            // number of byte on a row
+    if( IsPowerOfTwo( fragNb ) != false )
+    {
+        decoder->ParityRowModulo = fragNb + 1;
+    }
+    else
     {
-       FragDecoder.MatrixM2B[i] = 0xFF;
+        decoder->ParityRowModulo = fragNb;
     }
+    decoder->ParityRowReciprocal = 0xFFFFFFFF / decoder->ParityRowModulo;
+    decoder->Status.FragNbLastRx = 0;
+    decoder->Status.FragNbLost = 0;
+    decoder->Status.MaxNbDataLineXor = 0;
+    decoder->Status.MatrixError = 0;
+    decoder->M2BLine = 0;
+
+    // Initialize missing fragments map and parity matrix
+    for( uint32_t i = 0; i < decoder->WorkspaceNbWords; i++ )
+    {
+        decoder->Workspace[i] = 0;
+    }
+#if( FRAG_DECODER_MATRIX_IN_STORAGE == 0 )
+    for( uint32_t i = 0; i < MATRIX_M2B_NB_WORDS( decoder->MaxNbLost ); i++ )
+    {
+       decoder->MatrixM2B[i] = 0xFFFFFFFF;
+    }
+#endif
     
     // Initialize final uncoded data buffer ( FRAG_MAX_NB * FRAG_MAX_SIZE )
     for( uint32_t i = 0; i < ( fragNb * fragSize ); i++ )
     {
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-        if( ( FragDecoder.Callbacks != NULL ) && ( FragDecoder.Callbacks->FragDecoderWrite != NULL ) )
-        {
-            uint8_t buffer[1] = { 0xFF };
-            FragDecoder.Callbacks->FragDecoderWrite( i, buffer, 1 );
-        }
+        uint8_t buffer[1] = { 0xFF };
+        StorageWrite( decoder, i, buffer, 1 );
 #else
-        FragDecoder.File[i] = 0xFF;
+        decoder->File[i] = 0xFF;
 #endif
     }
-    FragDecoder.Status.FragNbLost = 0;
-    FragDecoder.Status.FragNbLastRx = 0;
+    decoder->Status.FragNbLost = 0;
+    decoder->Status.FragNbLastRx = 0;
 }
 
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
@@ -298,86 +696,195 @@ uint32_t FragDecoderGetMaxFileSize( void )
 }
 #endif
 
+void FragDecoderSessionDeInit( uint8_t sessionId )
+{
+    if( sessionId < FRAG_DECODER_MAX_SESSIONS )
+    {
+        FragDecoders[sessionId].Workspace = NULL;
+    }
+}
+
+int32_t FragDecoderSessionProcess( uint8_t sessionId, uint16_t fragCounter, uint8_t *rawData )
+{
+    if( sessionId >= FRAG_DECODER_MAX_SESSIONS )
+    {
+        return FRAG_SESSION_NOT_STARTED;
+    }
+    return FragSessionProcess( &FragDecoders[sessionId], fragCounter, rawData );
+}
+
+FragDecoderStatus_t FragDecoderSessionGetStatus( uint8_t sessionId )
+{
+    if( sessionId >= FRAG_DECODER_MAX_SESSIONS )
+    {
+        sessionId = 0;
+    }
+    return FragDecoders[sessionId].Status;
+}
+
 int32_t FragDecoderProcess( uint16_t fragCounter, uint8_t *rawData )
+{
+    return FragSessionProcess( &FragDecoders[0], fragCounter, rawData );
+}
+
+FragDecoderStatus_t FragDecoderGetStatus( void )
+{ 
+    return FragDecoders[0].Status;
+}
+
+static uint32_t* FragArenaAlloc( uint32_t nbWords )
+{
+    // First fit. Candidate locations are the arena start and the end of each
+    // allocated workspace
+    for( uint8_t i = 0; i <= FRAG_DECODER_MAX_SESSIONS; i++ )
+    {
+        uint32_t start = 0;
+        bool isFree = true;
+
+        if( i > 0 )
+        {
+            if( FragDecoders[i - 1].Workspace == NULL )
+            {
+                continue;
+            }
+            start = ( FragDecoders[i - 1].Workspace - FragArena ) + FragDecoders[i - 1].WorkspaceNbWords;
+        }
+        if( ( start + nbWords ) > ARENA_NB_WORDS )
+        {
+            continue;
+        }
+        for( uint8_t j = 0; j < FRAG_DECODER_MAX_SESSIONS; j++ )
+        {
+            if( FragDecoders[j].Workspace != NULL )
+            {
+                uint32_t end = ( FragDecoders[j].Workspace - FragArena ) + FragDecoders[j].WorkspaceNbWords;
+
+                if( ( start < end ) && ( ( uint32_t )( FragDecoders[j].Workspace - FragArena ) < ( start + nbWords ) ) )
+                {
+                    isFree = false;
+                    break;
+                }
+            }
+        }
+        if( isFree == true )
+        {
+            return &FragArena[start];
+        }
+    }
+    return NULL;
+}
+
+static int32_t FragSessionProcess( FragDecoder_t *decoder, uint16_t fragCounter, uint8_t *rawData )
+{
+    int32_t status;
+
+    if( decoder->Workspace == NULL )
+    {
+        return FRAG_SESSION_NOT_STARTED;
+    }
+    decoder->NbDataLineXor = 0;
+    status = FragProcess( decoder, fragCounter, rawData );
+    if( decoder->NbDataLineXor > decoder->Status.MaxNbDataLineXor )
+    {
+        decoder->Status.MaxNbDataLineXor = decoder->NbDataLineXor;
+    }
+#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
+    if( status >= 0 )
+    {
+        // Session completed. Make sure the whole file is in the storage
+        StorageFlush( decoder );
+    }
+#endif
+    return status;
+}
+
+static int32_t FragProcess( FragDecoder_t *decoder, uint16_t fragCounter, uint8_t *rawData )
 {
     uint16_t firstOneInRow = 0;
     int32_t first = 0;
     int32_t noInfo = 0;
 
-    uint8_t matrixRow[(FRAG_MAX_NB >> 3 ) + 1];
-    uint8_t matrixDataTemp[FRAG_MAX_SIZE];
-    uint8_t dataTempVector[( FRAG_MAX_REDUNDANCY >> 3 ) + 1];
-    uint8_t dataTempVector2[( FRAG_MAX_REDUNDANCY >> 3 ) + 1];
+    uint32_t matrixRow[BIT_ARRAY_NB_WORDS( FRAG_MAX_NB )];
+    // Word aligned in order to allow word-wise data lines XOR
+    uint32_t matrixDataTempWords[BIT_ARRAY_NB_WORDS( FRAG_MAX_SIZE * 8 )];
+    uint8_t *matrixDataTemp = ( uint8_t* )matrixDataTempWords;
+    uint32_t dataTempVector[BIT_ARRAY_NB_WORDS( FRAG_MAX_REDUNDANCY )];
+    uint32_t dataTempVector2[BIT_ARRAY_NB_WORDS( FRAG_MAX_REDUNDANCY )];
 
-    memset1( matrixRow, 0, ( FRAG_MAX_NB >> 3 ) + 1 );
+    memset1( ( uint8_t* )matrixRow, 0, sizeof( matrixRow ) );
     memset1( matrixDataTemp, 0, FRAG_MAX_SIZE );
-    memset1( dataTempVector, 0, ( FRAG_MAX_REDUNDANCY >> 3 ) + 1 );
-    memset1( dataTempVector2, 0, ( FRAG_MAX_REDUNDANCY >> 3 ) + 1 );
+    memset1( ( uint8_t* )dataTempVector, 0, sizeof( dataTempVector ) );
+    memset1( ( uint8_t* )dataTempVector2, 0, sizeof( dataTempVector2 ) );
 
-    FragDecoder.Status.FragNbRx = fragCounter;
+    decoder->Status.FragNbRx = fragCounter;
 
-    if( fragCounter < FragDecoder.Status.FragNbLastRx )
+    if( fragCounter < decoder->Status.FragNbLastRx )
     {
         return FRAG_SESSION_ONGOING;  // Drop frame out of order
     }
 
     // The M (FragNb) first packets aren't encoded or in other words they are
     // encoded with the unitary matrix
-    if( fragCounter < ( FragDecoder.FragNb + 1 ) )
+    if( fragCounter < ( decoder->FragNb + 1 ) )
     {
         // The M first frame are not encoded store them
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-        SetRow( rawData, fragCounter - 1, FragDecoder.FragSize );
+        SetRow( decoder, rawData, fragCounter - 1, decoder->FragSize );
 #else
-        SetRow( FragDecoder.File, rawData, fragCounter - 1, FragDecoder.FragSize );
+        SetRow( decoder->File, rawData, fragCounter - 1, decoder->FragSize );
 #endif
 
-        FragDecoder.FragNbMissingIndex[fragCounter - 1] = 0;
-
-        // Update the FragDecoder.FragNbMissingIndex with the loosing frame
-        FragFindMissingFrags( fragCounter );
+        // Update the FragDecoder.MissingFrags with the loosing frame
+        FragFindMissingFrags( decoder, fragCounter );
     }
     else
     {
-        if( FragDecoder.Status.FragNbLost > FRAG_MAX_REDUNDANCY )
+        if( decoder->Status.FragNbLost > decoder->MaxNbLost )
         {
-           FragDecoder.Status.MatrixError = 1;
+           decoder->Status.MatrixError = 1;
            return FRAG_SESSION_FINISHED;
         }
         // At this point we receive encoded frames and the number of loosing frames
         // is well known: FragDecoder.FragNbLost - 1;
 
         // In case of the end of true data is missing
-        FragFindMissingFrags( fragCounter );
+        FragFindMissingFrags( decoder, fragCounter );
 
-        if( FragDecoder.Status.FragNbLost == 0 )
+        if( decoder->Status.FragNbLost == 0 )
         { 
             // the case : all the M(FragNb) first rows have been transmitted with no error
-            return FragDecoder.Status.FragNbLost;
+            return decoder->Status.FragNbLost;
         }
 
         // fragCounter - FragDecoder.FragNb
-        FragGetParityMatrixRow( fragCounter - FragDecoder.FragNb, FragDecoder.FragNb, matrixRow );
+        FragGetParityMatrixRow( decoder, fragCounter - decoder->FragNb, decoder->FragNb, matrixRow );
 
-        for( int32_t i = 0; i < FragDecoder.FragNb; i++ )
+        // Only visit the coefficients set in the parity matrix row
+        for( uint16_t w = 0; w < BIT_ARRAY_NB_WORDS( decoder->FragNb ); w++ )
         {
-            if( GetParity( i , matrixRow ) == 1 )
+            uint32_t coefficients = matrixRow[w];
+
+            while( coefficients != 0 )
             {
-                if( FragDecoder.FragNbMissingIndex[i] == 0 )
+                int32_t i = ( w << 5 ) + CountTrailingZeros( coefficients );
+
+                // Clear the least significant bit set
+                coefficients &= coefficients - 1;
+
+                if( GetParity( i, decoder->MissingFrags ) == 0 )
                 {
                     // XOR with already receive frag
-                    SetParity( i, matrixRow, 0 );
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                    GetRow( matrixDataTemp, i, FragDecoder.FragSize );
+                    GetRow( decoder, matrixDataTemp, i, decoder->FragSize );
 #else
-                    GetRow( matrixDataTemp, FragDecoder.File, i, FragDecoder.FragSize );
+                    GetRow( matrixDataTemp, decoder->File, i, decoder->FragSize );
 #endif
-                    XorDataLine( rawData, matrixDataTemp, FragDecoder.FragSize );
+                    XorDataLine( decoder, rawData, matrixDataTemp, decoder->FragSize );
                 }
                 else
                 {
                     // Fill the "little" boolean matrix m2b
-                    SetParity( FragDecoder.FragNbMissingIndex[i] - 1, dataTempVector, 1 );
+                    SetParity( FragGetMissingFragRank( decoder, i ), dataTempVector, 1 );
                     if( first == 0 )
                     {
                         first = 1;
@@ -386,104 +893,177 @@ int32_t FragDecoderProcess( uint16_t fragCounter, uint8_t *rawData )
             }
         }
 
-        firstOneInRow = BitArrayFindFirstOne( dataTempVector, FragDecoder.Status.FragNbLost );
+        firstOneInRow = BitArrayFindFirstOne( dataTempVector, decoder->Status.FragNbLost );
 
         if( first > 0 )
         {
             int32_t li;
+#if( FRAG_DECODER_ONLINE_ELIMINATION == 0 )
             int32_t lj;
+#endif
 
             // Manage a new line in MatrixM2B
-            while( GetParity( firstOneInRow, FragDecoder.S ) == 1 )
+            while( GetParity( firstOneInRow, decoder->S ) == 1 )
             { 
                 // Row already diagonalized exist & ( FragDecoder.MatrixM2B[firstOneInRow][0] )
-                FragExtractLineFromBinaryMatrix( dataTempVector2, firstOneInRow, FragDecoder.Status.FragNbLost );
-                XorParityLine( dataTempVector, dataTempVector2, FragDecoder.Status.FragNbLost );
+                FragExtractLineFromBinaryMatrix( decoder, dataTempVector2, firstOneInRow, decoder->Status.FragNbLost );
+                XorParityLine( dataTempVector, dataTempVector2, decoder->Status.FragNbLost );
                 // Have to store it in the mi th position of the missing frag
-                li = FragFindMissingIndex( firstOneInRow );
+                li = FragFindMissingIndex( decoder, firstOneInRow );
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                GetRow( matrixDataTemp, li, FragDecoder.FragSize );
+                GetRow( decoder, matrixDataTemp, li, decoder->FragSize );
 #else
-                GetRow( matrixDataTemp, FragDecoder.File, li, FragDecoder.FragSize );
+                GetRow( matrixDataTemp, decoder->File, li, decoder->FragSize );
 #endif
-                XorDataLine( rawData, matrixDataTemp, FragDecoder.FragSize );
-                if( BitArrayIsAllZeros( dataTempVector, FragDecoder.Status.FragNbLost ) )
+                XorDataLine( decoder, rawData, matrixDataTemp, decoder->FragSize );
+                if( BitArrayIsAllZeros( dataTempVector, decoder->Status.FragNbLost ) )
                 {
                     noInfo = 1;
                     break;
                 }
-                firstOneInRow = BitArrayFindFirstOne( dataTempVector, FragDecoder.Status.FragNbLost );
+                firstOneInRow = BitArrayFindFirstOne( dataTempVector, decoder->Status.FragNbLost );
             }
 
             if( noInfo == 0 )
             {
-                FragPushLineToBinaryMatrix( dataTempVector, firstOneInRow, FragDecoder.Status.FragNbLost );
-                li = FragFindMissingIndex( firstOneInRow );
+#if( FRAG_DECODER_ONLINE_ELIMINATION == 1 )
+                FragReduceLine( decoder, dataTempVector, firstOneInRow, rawData, dataTempVector2, matrixDataTemp );
+#endif
+                FragPushLineToBinaryMatrix( decoder, dataTempVector, firstOneInRow, decoder->Status.FragNbLost );
+                li = FragFindMissingIndex( decoder, firstOneInRow );
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                SetRow( rawData, li, FragDecoder.FragSize );
+                SetRow( decoder, rawData, li, decoder->FragSize );
 #else
-                SetRow( FragDecoder.File, rawData, li, FragDecoder.FragSize );
+                SetRow( decoder->File, rawData, li, decoder->FragSize );
+#endif
+                SetParity( firstOneInRow, decoder->S, 1 );
+                decoder->M2BLine++;
+#if( FRAG_DECODER_ONLINE_ELIMINATION == 1 )
+                FragEliminateColumn( decoder, dataTempVector, firstOneInRow, rawData, dataTempVector2, matrixDataTemp );
 #endif
-                SetParity( firstOneInRow, FragDecoder.S, 1 );
-                FragDecoder.M2BLine++;
             }
 
-            if( FragDecoder.M2BLine == FragDecoder.Status.FragNbLost )
+            if( decoder->M2BLine == decoder->Status.FragNbLost )
             { 
+#if( FRAG_DECODER_ONLINE_ELIMINATION == 1 )
+                // The binary matrix is kept diagonalized, all the lost
+                // fragments are already recovered
+                return decoder->Status.FragNbLost;
+#else
                 // Then last step diagonalized
-                if( FragDecoder.Status.FragNbLost > 1 )
+                if( decoder->Status.FragNbLost > 1 )
                 {
                     int32_t i, j;
 
-                    for( i = ( FragDecoder.Status.FragNbLost - 2 ); i >= 0 ; i-- )
+                    for( i = ( decoder->Status.FragNbLost - 2 ); i >= 0 ; i-- )
                     {
-                        li = FragFindMissingIndex( i );
+                        li = FragFindMissingIndex( decoder, i );
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                        GetRow( matrixDataTemp, li, FragDecoder.FragSize );
+                        GetRow( decoder, matrixDataTemp, li, decoder->FragSize );
 #else
-                        GetRow( matrixDataTemp, FragDecoder.File, li, FragDecoder.FragSize );
+                        GetRow( matrixDataTemp, decoder->File, li, decoder->FragSize );
 #endif
-                        for( j = ( FragDecoder.Status.FragNbLost - 1 ); j > i; j--)
+                        for( j = ( decoder->Status.FragNbLost - 1 ); j > i; j--)
                         {
-                            FragExtractLineFromBinaryMatrix( dataTempVector2, i, FragDecoder.Status.FragNbLost );
-                            FragExtractLineFromBinaryMatrix( dataTempVector, j, FragDecoder.Status.FragNbLost );
+                            FragExtractLineFromBinaryMatrix( decoder, dataTempVector2, i, decoder->Status.FragNbLost );
+                            FragExtractLineFromBinaryMatrix( decoder, dataTempVector, j, decoder->Status.FragNbLost );
                             if( GetParity( j, dataTempVector2 ) == 1 )
                             {
-                                XorParityLine( dataTempVector2, dataTempVector, FragDecoder.Status.FragNbLost );
+                                XorParityLine( dataTempVector2, dataTempVector, decoder->Status.FragNbLost );
 
-                                lj = FragFindMissingIndex( j );
+                                lj = FragFindMissingIndex( decoder, j );
 
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                                GetRow( rawData, lj, FragDecoder.FragSize );
+                                GetRow( decoder, rawData, lj, decoder->FragSize );
 #else
-                                GetRow( rawData, FragDecoder.File, lj, FragDecoder.FragSize );
+                                GetRow( rawData, decoder->File, lj, decoder->FragSize );
 #endif
-                                XorDataLine( matrixDataTemp , rawData , FragDecoder.FragSize );
+                                XorDataLine( decoder, matrixDataTemp , rawData , decoder->FragSize );
                             }
                         }
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                        SetRow( matrixDataTemp, li, FragDecoder.FragSize );
+                        SetRow( decoder, matrixDataTemp, li, decoder->FragSize );
 #else
-                        SetRow( FragDecoder.File, matrixDataTemp, li, FragDecoder.FragSize );
+                        SetRow( decoder->File, matrixDataTemp, li, decoder->FragSize );
 #endif
                     }
-                    return FragDecoder.Status.FragNbLost;
+                    return decoder->Status.FragNbLost;
                 }
                 else
                 { 
                     //If not ( FragDecoder.FragNbLost > 1 )
-                    return FragDecoder.Status.FragNbLost;
+                    return decoder->Status.FragNbLost;
                 }
+#endif
             }
         }
     }
     return FRAG_SESSION_ONGOING;
 }
 
-FragDecoderStatus_t FragDecoderGetStatus( void )
-{ 
-    return FragDecoder.Status;
+#if( FRAG_DECODER_ONLINE_ELIMINATION == 1 )
+static void FragReduceLine( FragDecoder_t *decoder, uint32_t *line, uint16_t pivot, uint8_t *data, uint32_t *lineTemp, uint8_t *dataTemp )
+{
+    uint16_t nbLost = decoder->Status.FragNbLost;
+
+    for( uint16_t w = ( pivot >> 5 ); w < BIT_ARRAY_NB_WORDS( nbLost ); w++ )
+    {
+        // Stored lines have zeros in the other pivot columns, hence XORing
+        // one of them only clears its own pivot column bit in line
+        uint32_t pivots = line[w] & decoder->S[w] & BitArrayRangeMask( w, pivot + 1, nbLost );
+
+        while( pivots != 0 )
+        {
+            uint16_t j = ( w << 5 ) + CountTrailingZeros( pivots );
+
+            pivots &= pivots - 1;
+            FragExtractLineFromBinaryMatrix( decoder, lineTemp, j, nbLost );
+            XorParityLine( line, lineTemp, nbLost );
+#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
+            GetRow( decoder, dataTemp, FragFindMissingIndex( decoder, j ), decoder->FragSize );
+#else
+            GetRow( dataTemp, decoder->File, FragFindMissingIndex( decoder, j ), decoder->FragSize );
+#endif
+            XorDataLine( decoder, data, dataTemp, decoder->FragSize );
+        }
+    }
+}
+
+static void FragEliminateColumn( FragDecoder_t *decoder, uint32_t *line, uint16_t pivot, uint8_t *data, uint32_t *lineTemp, uint8_t *dataTemp )
+{
+    uint16_t nbLost = decoder->Status.FragNbLost;
+
+    // Only the lines with a lower pivot may have a one in the pivot column
+    for( uint16_t w = 0; w <= ( pivot >> 5 ); w++ )
+    {
+        uint32_t rows = decoder->S[w] & BitArrayRangeMask( w, 0, pivot );
+
+        while( rows != 0 )
+        {
+            uint16_t r = ( w << 5 ) + CountTrailingZeros( rows );
+
+            rows &= rows - 1;
+            FragExtractLineFromBinaryMatrix( decoder, lineTemp, r, nbLost );
+            if( GetParity( pivot, lineTemp ) == 1 )
+            {
+                uint16_t lr = FragFindMissingIndex( decoder, r );
+
+                XorParityLine( lineTemp, line, nbLost );
+                FragPushLineToBinaryMatrix( decoder, lineTemp, r, nbLost );
+#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
+                GetRow( decoder, dataTemp, lr, decoder->FragSize );
+                XorDataLine( decoder, dataTemp, data, decoder->FragSize );
+                SetRow( decoder, dataTemp, lr, decoder->FragSize );
+#else
+                GetRow( dataTemp, decoder->File, lr, decoder->FragSize );
+                XorDataLine( decoder, dataTemp, data, decoder->FragSize );
+                SetRow( decoder->File, dataTemp, lr, decoder->FragSize );
+#endif
+            }
+        }
+    }
 }
+#endif
 
 /*
  *=============================================================================
@@ -492,20 +1072,211 @@ FragDecoderStatus_t FragDecoderGetStatus( void )
  */
 
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-static void SetRow( uint8_t *src, uint16_t row, uint16_t size )
+/*!
+ * \brief Writes data to the storage through the application callback
+ *
+ * \param [IN] decoder Decoding session
+ * \param [IN] addr Storage address
+ * \param [IN] data Data buffer to be written
+ * \param [IN] size Number of bytes to be written
+ */
+static void StorageWriteDirect( FragDecoder_t *decoder, uint32_t addr, uint8_t *data, uint32_t size )
+{
+    if( ( decoder->Callbacks != NULL ) && ( decoder->Callbacks->FragDecoderWrite != NULL ) )
+    {
+        decoder->Status.StorageNbWrites++;
+        decoder->Callbacks->FragDecoderWrite( addr, data, size );
+    }
+}
+
+/*!
+ * \brief Reads data from the storage through the application callback
+ *
+ * \param [IN] decoder Decoding session
+ * \param [IN] addr Storage address
+ * \param [IN] data Data buffer to be filled
+ * \param [IN] size Number of bytes to be read
+ */
+static void StorageReadDirect( FragDecoder_t *decoder, uint32_t addr, uint8_t *data, uint32_t size )
 {
-    if( ( FragDecoder.Callbacks != NULL ) && ( FragDecoder.Callbacks->FragDecoderWrite != NULL ) )
+    if( ( decoder->Callbacks != NULL ) && ( decoder->Callbacks->FragDecoderRead != NULL ) )
     {
-        FragDecoder.Callbacks->FragDecoderWrite( row * size, src, size );
+        decoder->Status.StorageNbReads++;
+        decoder->Callbacks->FragDecoderRead( addr, data, size );
+    }
+}
+
+#if( FRAG_DECODER_CACHE_NB_PAGES > 0 )
+/*!
+ * \brief Checks if the storage accesses can go through the cache
+ *
+ * \param [IN] decoder Decoding session
+ * \param [IN] addr Storage address
+ * \param [IN] size Number of bytes to be accessed
+ *
+ * \retval enabled  True if the cache can be used
+ */
+static bool CacheIsEnabled( FragDecoder_t *decoder, uint32_t addr, uint32_t size )
+{
+    return ( decoder->Callbacks != NULL ) &&
+           ( decoder->Callbacks->PageSize != 0 ) &&
+           ( decoder->Callbacks->PageSize <= FRAG_DECODER_CACHE_PAGE_MAX_SIZE ) &&
+           ( ( addr + size ) <= decoder->StorageSize );
+}
+
+/*!
+ * \brief Gets the number of bytes of a page held by the storage. The last
+ *        page may be shorter than the page size
+ *
+ * \param [IN] decoder  Decoding session
+ * \param [IN] pageAddr Page storage address
+ *
+ * \retval length       Page length
+ */
+static uint32_t CacheGetPageLength( FragDecoder_t *decoder, uint32_t pageAddr )
+{
+    uint32_t length = decoder->StorageSize - pageAddr;
+
+    if( length > decoder->Callbacks->PageSize )
+    {
+        length = decoder->Callbacks->PageSize;
+    }
+    return length;
+}
+
+/*!
+ * \brief Gets the cached page for the given address. On a miss the least
+ *        recently used page is written back if needed and replaced
+ *
+ * \param [IN] decoder  Decoding session
+ * \param [IN] pageAddr Page storage address
+ * \param [IN] load     Reads the page from the storage on a miss if true
+ *
+ * \retval page         Pointer to the cached page
+ */
+static FragCachePage_t* CacheGetPage( FragDecoder_t *decoder, uint32_t pageAddr, bool load )
+{
+    FragCachePage_t *page = &decoder->CachePages[0];
+
+    for( uint8_t i = 0; i < FRAG_DECODER_CACHE_NB_PAGES; i++ )
+    {
+        FragCachePage_t *candidate = &decoder->CachePages[i];
+
+        if( ( candidate->Valid == true ) && ( candidate->Addr == pageAddr ) )
+        {
+            candidate->LastUse = ++decoder->CacheAccessCounter;
+            return candidate;
+        }
+        if( ( page->Valid == true ) &&
+            ( ( candidate->Valid == false ) || ( candidate->LastUse < page->LastUse ) ) )
+        {
+            page = candidate;
+        }
+    }
+
+    if( ( page->Valid == true ) && ( page->Dirty == true ) )
+    {
+        StorageWriteDirect( decoder, page->Addr, page->Data, CacheGetPageLength( decoder, page->Addr ) );
+    }
+    page->Addr = pageAddr;
+    page->Valid = true;
+    page->Dirty = false;
+    page->LastUse = ++decoder->CacheAccessCounter;
+    if( load == true )
+    {
+        StorageReadDirect( decoder, pageAddr, page->Data, CacheGetPageLength( decoder, pageAddr ) );
+    }
+    return page;
+}
+#endif
+
+static void StorageWrite( FragDecoder_t *decoder, uint32_t addr, uint8_t *data, uint32_t size )
+{
+#if( FRAG_DECODER_CACHE_NB_PAGES > 0 )
+    if( CacheIsEnabled( decoder, addr, size ) == true )
+    {
+        uint32_t pageSize = decoder->Callbacks->PageSize;
+
+        while( size > 0 )
+        {
+            uint32_t pageAddr = addr - ( addr % pageSize );
+            uint32_t pageOffset = addr - pageAddr;
+            uint32_t pageLength = CacheGetPageLength( decoder, pageAddr );
+            uint32_t length = pageLength - pageOffset;
+
+            if( length > size )
+            {
+                length = size;
+            }
+            // No need to read the page when it is fully overwritten
+            FragCachePage_t *page = CacheGetPage( decoder, pageAddr, length != pageLength );
+
+            memcpy1( &page->Data[pageOffset], data, length );
+            page->Dirty = true;
+            addr += length;
+            data += length;
+            size -= length;
+        }
+        return;
+    }
+#endif
+    StorageWriteDirect( decoder, addr, data, size );
+}
+
+static void StorageRead( FragDecoder_t *decoder, uint32_t addr, uint8_t *data, uint32_t size )
+{
+#if( FRAG_DECODER_CACHE_NB_PAGES > 0 )
+    if( CacheIsEnabled( decoder, addr, size ) == true )
+    {
+        uint32_t pageSize = decoder->Callbacks->PageSize;
+
+        while( size > 0 )
+        {
+            uint32_t pageAddr = addr - ( addr % pageSize );
+            uint32_t pageOffset = addr - pageAddr;
+            uint32_t length = CacheGetPageLength( decoder, pageAddr ) - pageOffset;
+
+            if( length > size )
+            {
+                length = size;
+            }
+            FragCachePage_t *page = CacheGetPage( decoder, pageAddr, true );
+
+            memcpy1( data, &page->Data[pageOffset], length );
+            addr += length;
+            data += length;
+            size -= length;
+        }
+        return;
     }
+#endif
+    StorageReadDirect( decoder, addr, data, size );
 }
 
-static void GetRow( uint8_t *dst, uint16_t row, uint16_t size )
+static void StorageFlush( FragDecoder_t *decoder )
 {
-    if( ( FragDecoder.Callbacks != NULL ) && ( FragDecoder.Callbacks->FragDecoderRead != NULL ) )
+#if( FRAG_DECODER_CACHE_NB_PAGES > 0 )
+    for( uint8_t i = 0; i < FRAG_DECODER_CACHE_NB_PAGES; i++ )
     {
-        FragDecoder.Callbacks->FragDecoderRead( row * size, dst, size );
+        FragCachePage_t *page = &decoder->CachePages[i];
+
+        if( ( page->Valid == true ) && ( page->Dirty == true ) )
+        {
+            StorageWriteDirect( decoder, page->Addr, page->Data, CacheGetPageLength( decoder, page->Addr ) );
+            page->Dirty = false;
+        }
     }
+#endif
+}
+
+static void SetRow( FragDecoder_t *decoder, uint8_t *src, uint16_t row, uint16_t size )
+{
+    StorageWrite( decoder, ( uint32_t )row * size, src, size );
+}
+
+static void GetRow( FragDecoder_t *decoder, uint8_t *dst, uint16_t row, uint16_t size )
+{
+    StorageRead( decoder, ( uint32_t )row * size, dst, size );
 }
 #else
 static void SetRow( uint8_t *dst, uint8_t *src, uint16_t row, uint16_t size )
@@ -519,19 +1290,90 @@ static void GetRow( uint8_t *dst, uint8_t *src, uint16_t row, uint16_t size )
 }
 #endif
 
-static uint8_t GetParity( uint16_t index, uint8_t *matrixRow  )
+static uint8_t GetParity( uint16_t index, uint32_t *matrixRow  )
+{
+    return ( matrixRow[index >> 5] >> ( index & 0x1F ) ) & 0x01;
+}
+
+static void SetParity( uint16_t index, uint32_t *matrixRow, uint8_t parity )
+{
+    uint32_t mask = ( uint32_t )1 << ( index & 0x1F );
+
+    if( parity != 0 )
+    {
+        matrixRow[index >> 5] |= mask;
+    }
+    else
+    {
+        matrixRow[index >> 5] &= ~mask;
+    }
+}
+
+static uint8_t BitCount( uint32_t x )
+{
+    x = x - ( ( x >> 1 ) & 0x55555555 );
+    x = ( x & 0x33333333 ) + ( ( x >> 2 ) & 0x33333333 );
+    x = ( x + ( x >> 4 ) ) & 0x0F0F0F0F;
+    return ( uint8_t )( ( x * 0x01010101 ) >> 24 );
+}
+
+static uint8_t CountTrailingZeros( uint32_t x )
 {
-    uint8_t parity;
-    parity = matrixRow[index >> 3];
-    parity = ( parity >> ( 7 - ( index % 8 ) ) ) & 0x01;
-    return parity;
+    // De Bruijn sequence based lookup. Portable and constant time, even on
+    // cores without a count leading zeros instruction.
+    static const uint8_t deBruijnBitPosition[32] =
+    {
+        0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+        31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+    };
+    return deBruijnBitPosition[( uint32_t )( ( x & ( ~x + 1 ) ) * 0x077CB531UL ) >> 27];
 }
 
-static void SetParity( uint16_t index, uint8_t *matrixRow, uint8_t parity )
+#if( FRAG_DECODER_MATRIX_IN_STORAGE == 0 )
+static uint32_t BitArrayGetWord( uint32_t *bitArray, uint32_t offset )
 {
-    uint8_t mask = 0xFF - ( 1 << ( 7 - ( index % 8 ) ) );
-    parity = parity << ( 7 - ( index % 8 ) );
-    matrixRow[index >> 3] = ( matrixRow[index >> 3] & mask ) + parity;
+    uint32_t shift = offset & 0x1F;
+    uint32_t word = bitArray[offset >> 5] >> shift;
+
+    if( shift != 0 )
+    {
+        word |= bitArray[( offset >> 5 ) + 1] << ( 32 - shift );
+    }
+    return word;
+}
+
+static void BitArraySetWord( uint32_t *bitArray, uint32_t offset, uint32_t word, uint32_t mask )
+{
+    uint32_t shift = offset & 0x1F;
+    uint32_t *dst = &bitArray[offset >> 5];
+
+    word &= mask;
+    dst[0] = ( dst[0] & ~( mask << shift ) ) | ( word << shift );
+    if( shift != 0 )
+    {
+        dst[1] = ( dst[1] & ~( mask >> ( 32 - shift ) ) ) | ( word >> ( 32 - shift ) );
+    }
+}
+#endif
+
+static uint32_t BitArrayRangeMask( uint16_t wordIndex, uint16_t first, uint16_t last )
+{
+    uint32_t wordStart = ( uint32_t )wordIndex << 5;
+    uint32_t mask = 0xFFFFFFFF;
+
+    if( ( first >= ( wordStart + 32 ) ) || ( last <= wordStart ) )
+    {
+        return 0;
+    }
+    if( first > wordStart )
+    {
+        mask &= 0xFFFFFFFF << ( first - wordStart );
+    }
+    if( last < ( wordStart + 32 ) )
+    {
+        mask &= 0xFFFFFFFF >> ( wordStart + 32 - last );
+    }
+    return mask;
 }
 
 static bool IsPowerOfTwo( uint32_t x )
@@ -549,19 +1391,35 @@ static bool IsPowerOfTwo( uint32_t x )
     return false;
 }
 
-static void XorDataLine( uint8_t *line1, uint8_t *line2, int32_t size )
+static void XorDataLine( FragDecoder_t *decoder, uint8_t *line1, uint8_t *line2, int32_t size )
 {
-    for( int32_t i = 0; i < size; i++ )
+    int32_t i = 0;
+    uint32_t word1 = 0;
+    uint32_t word2 = 0;
+
+    decoder->NbDataLineXor++;
+
+    // Word-wise XOR. memcpy keeps the accesses valid whatever the lines
+    // alignment and is turned into plain word accesses where allowed
+    for( ; ( i + 4 ) <= size; i += 4 )
+    {
+        memcpy( &word1, &line1[i], sizeof( uint32_t ) );
+        memcpy( &word2, &line2[i], sizeof( uint32_t ) );
+        word1 ^= word2;
+        memcpy( &line1[i], &word1, sizeof( uint32_t ) );
+    }
+    for( ; i < size; i++ )
     {
         line1[i] = line1[i] ^ line2[i];
     }
 }
 
-static void XorParityLine( uint8_t* line1, uint8_t* line2, int32_t size )
+static void XorParityLine( uint32_t* line1, uint32_t* line2, int32_t size )
 {
-    for( int32_t i = 0; i < size; i++ )
+    // Bits beyond size are always zero in both lines
+    for( int32_t i = 0; i < BIT_ARRAY_NB_WORDS( size ); i++ )
     {
-        SetParity( i, line1, ( GetParity( i, line1 ) ^ GetParity( i, line2 ) ) );
+        line1[i] ^= line2[i];
     }
 }
 
@@ -572,57 +1430,56 @@ static int32_t FragPrbs23( int32_t value )
     return ( value >> 1 ) + ( ( b0 ^ b1 ) << 22 );
 }
 
-static void FragGetParityMatrixRow( int32_t n, int32_t m, uint8_t *matrixRow )
+static void FragGetParityMatrixRow( FragDecoder_t *decoder, int32_t n, int32_t m, uint32_t *matrixRow )
 {
-    int32_t mTemp;
+    uint32_t modulo = decoder->ParityRowModulo;
+    uint32_t reciprocal = decoder->ParityRowReciprocal;
     int32_t x;
     int32_t nbCoeff = 0;
-    int32_t r;
-
-    if( IsPowerOfTwo( m ) != false )
-    {
-        mTemp = 1;
-    }
-    else 
-    {
-        mTemp = 0;
-    }
+    uint32_t r;
 
     x = 1 + ( 1001 * n );
-    for( uint16_t i = 0; i < ( ( m >> 3 ) + 1 ); i++ )
+    for( uint16_t i = 0; i < BIT_ARRAY_NB_WORDS( m ); i++ )
     {
         matrixRow[i] = 0;
     }
     while( nbCoeff < ( m >> 1 ) )
     {
-        r = 1 << 16;
-        while( r >= m )
+        do
         {
             x = FragPrbs23( x );
-            r = x % ( m + mTemp );
-        }
-        SetParity( r, matrixRow, 1 );
+            // r = x % modulo. As x < 2^23 the quotient estimate is either
+            // exact or one below, a single correction step is enough.
+            r = ( uint32_t )x - ( ( uint32_t )( ( ( uint64_t )( uint32_t )x * reciprocal ) >> 32 ) * modulo );
+            if( r >= modulo )
+            {
+                r -= modulo;
+            }
+        }while( r >= ( uint32_t )m );
+        matrixRow[r >> 5] |= 1UL << ( r & 0x1F );
         nbCoeff += 1;
     }
 }
 
-static uint16_t BitArrayFindFirstOne( uint8_t *bitArray, uint16_t size )
+static uint16_t BitArrayFindFirstOne( uint32_t *bitArray, uint16_t size )
 {
-    for( uint16_t i = 0; i < size; i++)
+    for( uint16_t i = 0; i < BIT_ARRAY_NB_WORDS( size ); i++ )
     {
-        if ( GetParity( i, bitArray ) == 1 )
+        uint32_t word = bitArray[i] & BitArrayRangeMask( i, 0, size );
+
+        if( word != 0 )
         {
-            return i;
+            return ( i << 5 ) + CountTrailingZeros( word );
         }
     }
     return 0;
 }
 
-static uint8_t BitArrayIsAllZeros( uint8_t *bitArray, uint16_t  size )
+static uint8_t BitArrayIsAllZeros( uint32_t *bitArray, uint16_t  size )
 {
-    for( uint16_t i = 0; i < size; i++ )
+    for( uint16_t i = 0; i < BIT_ARRAY_NB_WORDS( size ); i++ )
     {
-        if( GetParity( i, bitArray ) == 1 )
+        if( ( bitArray[i] & BitArrayRangeMask( i, 0, size ) ) != 0 )
         {
             return 0;
         }
@@ -633,87 +1490,157 @@ static uint8_t BitArrayIsAllZeros( uint8_t *bitArray, uint16_t  size )
 /*!
  * \brief Finds & marks missing fragments
  *
+ * \param [IN] decoder  Decoding session
  * \param [IN]  counter Current fragment counter
- * \param [OUT] FragDecoder.FragNbMissingIndex[] array is updated in place
+ * \param [OUT] FragDecoder.MissingFrags[] map is updated in place
  */
-static void FragFindMissingFrags( uint16_t counter )
+static void FragFindMissingFrags( FragDecoder_t *decoder, uint16_t counter )
 {
     int32_t i;
-    for( i = FragDecoder.Status.FragNbLastRx; i < ( counter - 1 ); i++ )
+    for( i = decoder->Status.FragNbLastRx; i < ( counter - 1 ); i++ )
     {
-        if( i < FragDecoder.FragNb )
+        if( i < decoder->FragNb )
         {
-            FragDecoder.Status.FragNbLost++;
-            FragDecoder.FragNbMissingIndex[i] = FragDecoder.Status.FragNbLost;
+            decoder->Status.FragNbLost++;
+            SetParity( i, decoder->MissingFrags, 1 );
         }
     }
-    if( i < FragDecoder.FragNb )
+    if( i < decoder->FragNb )
     {
-        FragDecoder.Status.FragNbLastRx = counter;
+        decoder->Status.FragNbLastRx = counter;
     }
     else
     {
-        FragDecoder.Status.FragNbLastRx = FragDecoder.FragNb + 1;
+        if( decoder->Status.FragNbLastRx <= decoder->FragNb )
+        {
+            // All the uncoded fragments have been handled
+            FragBuildMissingFragsRank( decoder );
+        }
+        decoder->Status.FragNbLastRx = decoder->FragNb + 1;
     }
-    DBG( "RECEIVED    : %5d / %5d Fragments\n", FragDecoder.Status.FragNbRx, FragDecoder.FragNb );
-    DBG( "              %5d / %5d Bytes\n", FragDecoder.Status.FragNbRx * FragDecoder.FragSize, FragDecoder.FragNb * FragDecoder.FragSize );
-    DBG( "LOST        :       %7d Fragments\n\n", FragDecoder.Status.FragNbLost );
+    DBG( "RECEIVED    : %5d / %5d Fragments\n", decoder->Status.FragNbRx, decoder->FragNb );
+    DBG( "              %5d / %5d Bytes\n", decoder->Status.FragNbRx * decoder->FragSize, decoder->FragNb * decoder->FragSize );
+    DBG( "LOST        :       %7d Fragments\n\n", decoder->Status.FragNbLost );
 }
 
 /*!
  * \brief Finds the index (frag counter) of the x th missing frag
  *
+ * \param [IN] decoder Decoding session
  * \param [IN] x   x th missing frag
  *
  * \retval counter The counter value associated to the x th missing frag
  */
-static uint16_t FragFindMissingIndex( uint16_t x )
+static uint16_t FragFindMissingIndex( FragDecoder_t *decoder, uint16_t x )
 {
-    for( uint16_t i = 0; i < FragDecoder.FragNb; i++ )
+    uint16_t block = 0;
+
+    while( ( ( block + 1 ) < MISSING_FRAGS_NB_BLOCKS( decoder->FragNb ) ) && ( decoder->MissingFragsRank[block + 1] <= x ) )
     {
-        if( FragDecoder.FragNbMissingIndex[i] == ( x + 1 ) )
+        block++;
+    }
+    x -= decoder->MissingFragsRank[block];
+
+    for( uint16_t i = block * MISSING_FRAGS_BLOCK_NB_WORDS; i < BIT_ARRAY_NB_WORDS( decoder->FragNb ); i++ )
+    {
+        uint32_t word = decoder->MissingFrags[i];
+        uint8_t count = BitCount( word );
+
+        if( x < count )
         {
-            return i;
+            // Clear the x first bits set, the x th missing frag is the next one
+            for( ; x > 0; x-- )
+            {
+                word &= word - 1;
+            }
+            return ( i << 5 ) + CountTrailingZeros( word );
         }
+        x -= count;
     }
     return 0;
 }
 
+static void FragBuildMissingFragsRank( FragDecoder_t *decoder )
+{
+    uint16_t rank = 0;
+
+    for( uint16_t i = 0; i < BIT_ARRAY_NB_WORDS( decoder->FragNb ); i++ )
+    {
+        if( ( i % MISSING_FRAGS_BLOCK_NB_WORDS ) == 0 )
+        {
+            decoder->MissingFragsRank[i / MISSING_FRAGS_BLOCK_NB_WORDS] = rank;
+        }
+        rank += BitCount( decoder->MissingFrags[i] );
+    }
+}
+
+static uint16_t FragGetMissingFragRank( FragDecoder_t *decoder, uint16_t index )
+{
+    uint16_t block = ( index >> 5 ) / MISSING_FRAGS_BLOCK_NB_WORDS;
+    uint16_t rank = decoder->MissingFragsRank[block];
+
+    for( uint16_t i = block * MISSING_FRAGS_BLOCK_NB_WORDS; i < ( index >> 5 ); i++ )
+    {
+        rank += BitCount( decoder->MissingFrags[i] );
+    }
+    return rank + BitCount( decoder->MissingFrags[index >> 5] & ( ( 1UL << ( index & 0x1F ) ) - 1 ) );
+}
+
+#if( FRAG_DECODER_MATRIX_IN_STORAGE == 1 )
+/*!
+ * \brief Gets the storage address of a binary matrix row. Rows are stored
+ *        after the file and hold full bit arrays of bitsInRow bits.
+ *
+ * \param [IN] decoder   Decoding session
+ * \param [IN] rowIndex  Matrix row index
+ * \param [IN] bitsInRow Number of bits in one row
+ *
+ * \retval addr          Storage address of the row
+ */
+static uint32_t FragGetBinaryMatrixRowAddr( FragDecoder_t *decoder, uint16_t rowIndex, uint16_t bitsInRow )
+{
+    return ( ( uint32_t )decoder->FragNb * decoder->FragSize ) +
+           ( ( uint32_t )rowIndex * BIT_ARRAY_NB_WORDS( bitsInRow ) * 4 );
+}
+
+static void FragExtractLineFromBinaryMatrix( FragDecoder_t *decoder, uint32_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow )
+{
+    StorageRead( decoder, FragGetBinaryMatrixRowAddr( decoder, rowIndex, bitsInRow ), ( uint8_t* )bitArray, BIT_ARRAY_NB_WORDS( bitsInRow ) * 4 );
+}
+
+static void FragPushLineToBinaryMatrix( FragDecoder_t *decoder, uint32_t *bitArray, uint16_t rowIndex, uint16_t bitsInRow )
+{
+    // The columns before rowIndex are always zero, hence the row can be
+    // stored as is
+    StorageWrite( decoder, FragGetBinaryMatrixRowAddr( decoder, rowIndex, bitsInRow ), ( uint8_t* )bitArray, BIT_ARRAY_NB_WORDS( bitsInRow ) * 4 );
+}
+#else
 /*!
  * \brief Extacts a row from the binary matrix and expands it to a bitArray
  *
+ * \param [IN] decoder   Decoding session
  * \param [IN] bitArray  Pointer to the bit array
  * \param [IN] rowIndex  Matrix row index
  * \param [IN] bitsInRow Number of bits in one row
  */
-static void FragExtractLineFromBinaryMatrix( uint8_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow )
+static void FragExtractLineFromBinaryMatrix( FragDecoder_t *decoder, uint32_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow )
 {
-    uint32_t findByte = 0;
-    uint32_t findBitInByte = 0;
+    // The row rowIndex stores the columns [rowIndex, bitsInRow[ starting at
+    // bit rowIndex * bitsInRow - rowIndex * ( rowIndex - 1 ) / 2, hence the
+    // column i is located at bit offset + i.
+    uint32_t offset = ( rowIndex * ( bitsInRow - 1 ) ) - ( ( rowIndex * ( rowIndex - 1 ) ) >> 1 );
 
-    if( rowIndex > 0 )
+    for( uint16_t i = 0; i < BIT_ARRAY_NB_WORDS( bitsInRow ); i++ )
     {
-        findByte      = ( rowIndex * bitsInRow - ( ( rowIndex * ( rowIndex - 1 ) ) >> 1 ) ) >> 3;
-        findBitInByte = ( rowIndex * bitsInRow - ( ( rowIndex * ( rowIndex - 1 ) ) >> 1 ) ) % 8;
-    }
-    if( rowIndex > 0 )
-    {
-        for( uint16_t i = 0; i < rowIndex; i++ )
+        uint32_t mask = BitArrayRangeMask( i, rowIndex, bitsInRow );
+
+        if( mask == 0 )
         {
-            SetParity( i, bitArray, 0 );
+            bitArray[i] = 0;
         }
-    }
-    for( uint16_t i = rowIndex; i < bitsInRow; i++ )
-    {
-        SetParity( i,
-                   bitArray, 
-                   ( FragDecoder.MatrixM2B[findByte] >> ( 7 - findBitInByte ) ) & 0x01 );
-
-        findBitInByte++;
-        if( findBitInByte == 8 )
+        else
         {
-            findBitInByte = 0;
-            findByte++;
+            bitArray[i] = BitArrayGetWord( decoder->MatrixM2B, offset + ( i << 5 ) ) & mask;
         }
     }
 }
@@ -721,31 +1648,20 @@ static void FragExtractLineFromBinaryMatrix( uint8_t* bitArray, uint16_t rowInde
 /*!
  * \brief Collapses and Pushs a row of a bit array to the matrix
  *
+ * \param [IN] decoder   Decoding session
  * \param [IN] bitArray  Pointer to the bit array
  * \param [IN] rowIndex  Matrix row index
  * \param [IN] bitsInRow Number of bits in one row
  */
-static void FragPushLineToBinaryMatrix( uint8_t *bitArray, uint16_t rowIndex, uint16_t bitsInRow )
+static void FragPushLineToBinaryMatrix( FragDecoder_t *decoder, uint32_t *bitArray, uint16_t rowIndex, uint16_t bitsInRow )
 {
-    uint32_t findByte = 0;
-    uint32_t findBitInByte = 0;
-
-    if ( rowIndex > 0) {
-        findByte      = ( rowIndex * bitsInRow - ( ( rowIndex * ( rowIndex - 1 ) ) >> 1 ) ) >> 3;
-        findBitInByte = ( rowIndex * bitsInRow - ( ( rowIndex * ( rowIndex - 1 ) ) >> 1 ) ) % 8;
+    uint32_t offset = ( rowIndex * ( bitsInRow - 1 ) ) - ( ( rowIndex * ( rowIndex - 1 ) ) >> 1 );
 
-    }
-    for( uint16_t i = rowIndex; i < bitsInRow; i++ )
+    for( uint16_t i = ( rowIndex >> 5 ); i < BIT_ARRAY_NB_WORDS( bitsInRow ); i++ )
     {
-        if( GetParity( i, bitArray ) == 0 )
-        {
-            FragDecoder.MatrixM2B[findByte] = FragDecoder.MatrixM2B[findByte] & ( 0xFF - ( 1 << ( 7 - findBitInByte ) ) );
-        }
-        findBitInByte++;
-        if( findBitInByte == 8 )
-        {
-            findBitInByte = 0;
-            findByte++;
-        }
+        uint32_t mask = BitArrayRangeMask( i, rowIndex, bitsInRow );
+
+        BitArraySetWord( decoder->MatrixM2B, offset + ( i << 5 ), bitArray[i], mask );
     }
 }
+#endif
@@ -31,26 +31,118 @@
  */
 #define FRAG_DECODER_FILE_HANDLING_NEW_API          1
 
+/*!
+ * If set to 1 the parity matrix used to recover the lost fragments is kept
+ * in the storage handled by \ref FragDecoderWrite and \ref FragDecoderRead
+ * callbacks instead of RAM. It is located right after the file, at address
+ * fragNb * fragSize, and requires up to \ref FRAG_MATRIX_STORAGE_SIZE bytes.
+ *
+ * \remark Only available with \ref FRAG_DECODER_FILE_HANDLING_NEW_API
+ */
+#ifndef FRAG_DECODER_MATRIX_IN_STORAGE
+#define FRAG_DECODER_MATRIX_IN_STORAGE              0
+#endif
+
 /*!
  * Maximum number of fragment that can be handled.
  *
  * \remark This parameter has an impact on the memory footprint.
  */
+#ifndef FRAG_MAX_NB
 #define FRAG_MAX_NB                                 21
+#endif
 
 /*!
  * Maximum fragment size that can be handled.
  *
  * \remark This parameter has an impact on the memory footprint.
  */
+#ifndef FRAG_MAX_SIZE
 #define FRAG_MAX_SIZE                               50
+#endif
 
 /*!
  * Maximum number of extra frames that can be handled.
  *
  * \remark This parameter has an impact on the memory footprint.
  */
+#ifndef FRAG_MAX_REDUNDANCY
 #define FRAG_MAX_REDUNDANCY                         5
+#endif
+
+/*!
+ * Storage size in bytes required by the parity matrix when
+ * \ref FRAG_DECODER_MATRIX_IN_STORAGE is set to 1.
+ *
+ * \remark The decoder RAM footprint, in bytes, is then
+ *         Static : 4 * ceil( FRAG_MAX_NB / 32 ) + 2 * ceil( FRAG_MAX_NB / 256 ) +
+ *                  4 * ceil( FRAG_MAX_REDUNDANCY / 32 )
+ *         Stack  : 4 * ceil( FRAG_MAX_NB / 32 ) + 4 * ceil( FRAG_MAX_SIZE / 4 ) +
+ *                  8 * ceil( FRAG_MAX_REDUNDANCY / 32 )
+ *         When the parity matrix is kept in RAM the static footprint grows by
+ *         4 * ( ceil( FRAG_MAX_REDUNDANCY * ( FRAG_MAX_REDUNDANCY + 1 ) / 64 ) + 1 )
+ */
+#define FRAG_MATRIX_STORAGE_SIZE                    ( FRAG_MAX_REDUNDANCY * ( ( FRAG_MAX_REDUNDANCY + 31 ) >> 5 ) * 4 )
+
+/*!
+ * If set to 1 the binary matrix is kept diagonalized as the coded fragments
+ * are received. The decoding cost is spread over the coded fragments instead
+ * of being spent at once when the last missing fragment is recovered.
+ */
+#ifndef FRAG_DECODER_ONLINE_ELIMINATION
+#define FRAG_DECODER_ONLINE_ELIMINATION             0
+#endif
+
+/*!
+ * Maximum number of decoding sessions handled concurrently. Each session is
+ * identified by an index in [0..FRAG_DECODER_MAX_SESSIONS-1]
+ *
+ * \remark Sessions other than 0 are only available with
+ *         \ref FRAG_DECODER_FILE_HANDLING_NEW_API
+ */
+#ifndef FRAG_DECODER_MAX_SESSIONS
+#define FRAG_DECODER_MAX_SESSIONS                   1
+#endif
+
+/*!
+ * Size in bytes of the workspace arena shared by the decoding sessions.
+ * A session of fragNb fragments takes, in 32 bits words,
+ *     ceil( fragNb / 32 ) + ceil( ceil( fragNb / 256 ) / 2 ) + ceil( R / 32 ) +
+ *     ceil( R * ( R + 1 ) / 64 ) + 1
+ * where R = min( fragNb, FRAG_MAX_REDUNDANCY ). The last two terms are not
+ * needed when \ref FRAG_DECODER_MATRIX_IN_STORAGE is set to 1.
+ *
+ * \remark When set to 0 the arena is sized to hold
+ *         \ref FRAG_DECODER_MAX_SESSIONS sessions of \ref FRAG_MAX_NB fragments
+ */
+#ifndef FRAG_DECODER_ARENA_SIZE
+#define FRAG_DECODER_ARENA_SIZE                     0
+#endif
+
+/*!
+ * Number of storage pages kept by the decoder write-back cache. When
+ * different from 0 the \ref FragDecoderWrite and \ref FragDecoderRead
+ * callbacks are called for whole pages of \ref FragDecoderCallbacks_t.PageSize
+ * bytes. Repeated row accesses are served from RAM and row writes are grouped
+ * into page writes. Modified pages are written back when a page is evicted
+ * and when the session completes.
+ *
+ * \remark Only available with \ref FRAG_DECODER_FILE_HANDLING_NEW_API
+ *
+ * \remark This parameter has an impact on the memory footprint.
+ *         RAM = FRAG_DECODER_MAX_SESSIONS * FRAG_DECODER_CACHE_NB_PAGES *
+ *               ( FRAG_DECODER_CACHE_PAGE_MAX_SIZE + 12 )
+ */
+#ifndef FRAG_DECODER_CACHE_NB_PAGES
+#define FRAG_DECODER_CACHE_NB_PAGES                 0
+#endif
+
+/*!
+ * Maximum storage page size handled by the decoder write-back cache.
+ */
+#ifndef FRAG_DECODER_CACHE_PAGE_MAX_SIZE
+#define FRAG_DECODER_CACHE_PAGE_MAX_SIZE            128
+#endif
 
 #define FRAG_SESSION_FINISHED                       ( int32_t )0
 #define FRAG_SESSION_NOT_STARTED                    ( int32_t )-2
@@ -62,6 +154,21 @@ typedef struct sFragDecoderStatus
     uint16_t FragNbLost;
     uint16_t FragNbLastRx;
     uint8_t MatrixError;
+    /*!
+     * Highest number of data lines XORed while processing a single fragment.
+     * Gives the worst case fragment processing time
+     */
+    uint32_t MaxNbDataLineXor;
+#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
+    /*!
+     * Number of \ref FragDecoderRead calls since the session start
+     */
+    uint32_t StorageNbReads;
+    /*!
+     * Number of \ref FragDecoderWrite calls since the session start
+     */
+    uint32_t StorageNbWrites;
+#endif
 }FragDecoderStatus_t;
 
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
@@ -87,12 +194,21 @@ typedef struct sFragDecoderCallbacks
      * \retval status Read operation status [0: Success, -1 Fail]
      */
     int8_t ( *FragDecoderRead )( uint32_t addr, uint8_t *data, uint32_t size );
+#if( FRAG_DECODER_CACHE_NB_PAGES > 0 )
+    /*!
+     * Storage page size in bytes. Cached pages are aligned on this size.
+     *
+     * \remark The cache is bypassed when set to 0 or when greater than
+     *         \ref FRAG_DECODER_CACHE_PAGE_MAX_SIZE
+     */
+    uint32_t PageSize;
+#endif
 }FragDecoderCallbacks_t;
 #endif
 
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
 /*!
- * \brief Initializes the fragmentation decoder
+ * \brief Initializes the fragmentation decoder session 0
  *
  * \param [IN] fragNb     Number of expected fragments (without redundancy packets)
  * \param [IN] fragSize   Size of a fragment
@@ -118,10 +234,55 @@ void FragDecoderInit( uint16_t fragNb, uint8_t fragSize, uint8_t *file, uint32_t
  * \retval size FileSize
  */
 uint32_t FragDecoderGetMaxFileSize( void );
+
+/*!
+ * \brief Initializes a fragmentation decoding session. The session workspace
+ *        is taken from the arena shared by all the sessions. On failure the
+ *        session previously running on this index is left untouched
+ *
+ * \param [IN] sessionId  Session index [0..FRAG_DECODER_MAX_SESSIONS-1]
+ * \param [IN] fragNb     Number of expected fragments (without redundancy packets)
+ * \param [IN] fragSize   Size of a fragment
+ * \param [IN] callbacks  Pointer to the Write/Read functions of the session.
+ *
+ * \retval status         [0: Success, -1: Invalid index or not enough memory]
+ */
+int8_t FragDecoderSessionInit( uint8_t sessionId, uint16_t fragNb, uint8_t fragSize, FragDecoderCallbacks_t *callbacks );
 #endif
 
 /*!
- * \brief Function to decode and reconstruct the binary file
+ * \brief Stops a fragmentation decoding session and gives its workspace back
+ *        to the arena. The session status remains available
+ *
+ * \param [IN] sessionId  Session index
+ */
+void FragDecoderSessionDeInit( uint8_t sessionId );
+
+/*!
+ * \brief Decodes a fragment of the given session. See \ref FragDecoderProcess
+ *
+ * \param [IN] sessionId   Session index
+ * \param [IN] fragCounter Fragment counter
+ * \param [IN] rawData     Pointer to the fragment to be processed
+ *
+ * \retval status          Process status. [FRAG_SESSION_NOT_STARTED,
+ *                                          FRAG_SESSION_ONGOING,
+ *                                          FRAG_SESSION_FINISHED or
+ *                                          FragDecoder.Status.FragNbLost]
+ */
+int32_t FragDecoderSessionProcess( uint8_t sessionId, uint16_t fragCounter, uint8_t *rawData );
+
+/*!
+ * \brief Gets the fragmentation status of the given session
+ *
+ * \param [IN] sessionId  Session index
+ *
+ * \retval status Fragmentation decoder status
+ */
+FragDecoderStatus_t FragDecoderSessionGetStatus( uint8_t sessionId );
+
+/*!
+ * \brief Function to decode and reconstruct the binary file of session 0
  *        Called for each receive frame
  * 
  * \param [IN] fragCounter Fragment counter [1..(FragDecoder.FragNb + FragDecoder.Redundancy)]
@@ -134,7 +295,7 @@ uint32_t FragDecoderGetMaxFileSize( void );
 int32_t FragDecoderProcess( uint16_t fragCounter, uint8_t *rawData );
 
 /*!
- * \brief Gets the current fragmentation status
+ * \brief Gets the current fragmentation status of session 0
  * 
  * \retval status Fragmentation decoder status
  */
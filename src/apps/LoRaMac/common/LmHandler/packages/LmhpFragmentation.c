@@ -31,8 +31,6 @@
 #define FRAGMENTATION_ID                            3
 #define FRAGMENTATION_VERSION                       1
 
-#define FRAGMENTATION_MAX_SESSIONS                  4
-
 // Fragmentation Tx delay state
 typedef enum LmhpFragmentationTxDelayStates_e
 {
@@ -116,6 +114,26 @@ static void LmhpFragmentationProcess( void );
  */
 static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication );
 
+/*!
+ * Gets the FragDecoder session used by a fragmentation session
+ *
+ * \param [IN] fragIndex Fragmentation session index
+ *
+ * \retval sessionId     FragDecoder session index
+ */
+static uint8_t GetDecoderSessionId( uint8_t fragIndex );
+
+#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
+/*!
+ * Gets the FragDecoder Write/Read callbacks used by a fragmentation session
+ *
+ * \param [IN] fragIndex Fragmentation session index
+ *
+ * \retval callbacks     FragDecoder callbacks of the session
+ */
+static FragDecoderCallbacks_t* GetDecoderCallbacks( uint8_t fragIndex );
+#endif
+
 static LmhpFragmentationState_t LmhpFragmentationState =
 {
     .Initialized = false,
@@ -303,7 +321,7 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
                 uint8_t participants = fragIndex & 0x01;
 
                 fragIndex >>= 1;
-                FragSessionData[fragIndex].FragDecoderStatus = FragDecoderGetStatus( );
+                FragSessionData[fragIndex].FragDecoderStatus = FragDecoderSessionGetStatus( GetDecoderSessionId( fragIndex ) );
 
                 if( ( participants == 1 ) ||
                     ( ( participants == 0 ) && ( FragSessionData[fragIndex].FragDecoderStatus.FragNbLost > 0 ) ) )
@@ -383,14 +401,32 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
 
                 if( ( status & 0x0F ) == 0 )
                 {
-                    // The FragSessionSetup is accepted
-                    fragSessionData.FragGroupData.IsActive = true;
-                    fragSessionData.FragDecoderPorcessStatus = FRAG_SESSION_ONGOING;
-                    FragSessionData[fragSessionData.FragGroupData.FragSession.Fields.FragIndex] = fragSessionData;
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                    FragDecoderInit( fragSessionData.FragGroupData.FragNb,
-                                     fragSessionData.FragGroupData.FragSize,
-                                     &LmhpFragmentationParams->DecoderCallbacks );
+                    uint8_t fragIndex = fragSessionData.FragGroupData.FragSession.Fields.FragIndex;
+                    uint8_t decoderSessionId = GetDecoderSessionId( fragIndex );
+                    FragDecoderCallbacks_t *callbacks = GetDecoderCallbacks( fragIndex );
+
+                    // The storage can't be shared with an ongoing session
+                    // decoded concurrently
+                    for( uint8_t i = 0; i < FRAGMENTATION_MAX_SESSIONS; i++ )
+                    {
+                        if( ( GetDecoderSessionId( i ) != decoderSessionId ) &&
+                            ( FragSessionData[i].FragDecoderPorcessStatus == FRAG_SESSION_ONGOING ) &&
+                            ( GetDecoderCallbacks( i ) == callbacks ) )
+                        {
+                            status |= 0x02; // Not enough Memory
+                        }
+                    }
+                    if( ( status & 0x0F ) == 0 )
+                    {
+                        if( FragDecoderSessionInit( decoderSessionId,
+                                                    fragSessionData.FragGroupData.FragNb,
+                                                    fragSessionData.FragGroupData.FragSize,
+                                                    callbacks ) != 0 )
+                        {
+                            status |= 0x02; // Not enough Memory
+                        }
+                    }
 #else
                     FragDecoderInit( fragSessionData.FragGroupData.FragNb,
                                      fragSessionData.FragGroupData.FragSize,
@@ -398,6 +434,25 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
                                      LmhpFragmentationParams->BufferSize );
 #endif
                 }
+                if( ( status & 0x0F ) == 0 )
+                {
+                    uint8_t fragIndex = fragSessionData.FragGroupData.FragSession.Fields.FragIndex;
+
+                    // The sessions sharing the same decoder session are
+                    // stopped once the new decoder session is initialized
+                    for( uint8_t i = 0; i < FRAGMENTATION_MAX_SESSIONS; i++ )
+                    {
+                        if( ( GetDecoderSessionId( i ) == GetDecoderSessionId( fragIndex ) ) &&
+                            ( FragSessionData[i].FragDecoderPorcessStatus == FRAG_SESSION_ONGOING ) )
+                        {
+                            FragSessionData[i].FragDecoderPorcessStatus = FRAG_SESSION_NOT_STARTED;
+                        }
+                    }
+                    // The FragSessionSetup is accepted
+                    fragSessionData.FragGroupData.IsActive = true;
+                    fragSessionData.FragDecoderPorcessStatus = FRAG_SESSION_ONGOING;
+                    FragSessionData[fragSessionData.FragGroupData.FragSession.Fields.FragIndex] = fragSessionData;
+                }
                 LmhpFragmentationState.DataBuffer[dataBufferIndex++] = FRAGMENTATION_FRAG_SESSION_SETUP_ANS;
                 LmhpFragmentationState.DataBuffer[dataBufferIndex++] = status;
                 isAnswerDelayed = false;
@@ -422,6 +477,12 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
                 {
                     // Delete session
                     FragSessionData[id].FragGroupData.IsActive = false;
+                    if( FragSessionData[id].FragDecoderPorcessStatus == FRAG_SESSION_ONGOING )
+                    {
+                        // Give the decoder workspace back
+                        FragSessionData[id].FragDecoderPorcessStatus = FRAG_SESSION_NOT_STARTED;
+                        FragDecoderSessionDeInit( GetDecoderSessionId( id ) );
+                    }
                 }
                 LmhpFragmentationState.DataBuffer[dataBufferIndex++] = FRAGMENTATION_FRAG_SESSION_DELETE_ANS;
                 LmhpFragmentationState.DataBuffer[dataBufferIndex++] = status;
@@ -457,8 +518,15 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
 
                 if( FragSessionData[fragIndex].FragDecoderPorcessStatus == FRAG_SESSION_ONGOING )
                 {
-                    FragSessionData[fragIndex].FragDecoderPorcessStatus = FragDecoderProcess( fragCounter, &mcpsIndication->Buffer[cmdIndex] );
-                    FragSessionData[fragIndex].FragDecoderStatus = FragDecoderGetStatus( );
+                    uint8_t decoderSessionId = GetDecoderSessionId( fragIndex );
+
+                    FragSessionData[fragIndex].FragDecoderPorcessStatus = FragDecoderSessionProcess( decoderSessionId, fragCounter, &mcpsIndication->Buffer[cmdIndex] );
+                    FragSessionData[fragIndex].FragDecoderStatus = FragDecoderSessionGetStatus( decoderSessionId );
+                    if( FragSessionData[fragIndex].FragDecoderPorcessStatus >= 0 )
+                    {
+                        // Decoding done, the workspace can be used by other sessions
+                        FragDecoderSessionDeInit( decoderSessionId );
+                    }
                     if( LmhpFragmentationParams->OnProgress != NULL )
                     {
                         LmhpFragmentationParams->OnProgress( FragSessionData[fragIndex].FragDecoderStatus.FragNbRx,
@@ -473,17 +541,25 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
                     {
                         // Fragmentation successfully done
                         FragSessionData[fragIndex].FragDecoderPorcessStatus = FRAG_SESSION_NOT_STARTED;
-                        if( LmhpFragmentationParams->OnDone != NULL )
-                        {
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
+                        if( LmhpFragmentationParams->OnSessionDone != NULL )
+                        {
+                            LmhpFragmentationParams->OnSessionDone( fragIndex, FragSessionData[fragIndex].FragDecoderPorcessStatus,
+                                                                    ( FragSessionData[fragIndex].FragGroupData.FragNb * FragSessionData[fragIndex].FragGroupData.FragSize ) - FragSessionData[fragIndex].FragGroupData.Padding );
+                        }
+                        else if( LmhpFragmentationParams->OnDone != NULL )
+                        {
                             LmhpFragmentationParams->OnDone( FragSessionData[fragIndex].FragDecoderPorcessStatus,
                                                             ( FragSessionData[fragIndex].FragGroupData.FragNb * FragSessionData[fragIndex].FragGroupData.FragSize ) - FragSessionData[fragIndex].FragGroupData.Padding );
+                        }
 #else
+                        if( LmhpFragmentationParams->OnDone != NULL )
+                        {
                             LmhpFragmentationParams->OnDone( FragSessionData[fragIndex].FragDecoderPorcessStatus,
                                                             LmhpFragmentationParams->Buffer,
                                                             ( FragSessionData[fragIndex].FragGroupData.FragNb * FragSessionData[fragIndex].FragGroupData.FragSize ) - FragSessionData[fragIndex].FragGroupData.Padding );
-#endif
                         }
+#endif
                     }
                 }
                 cmdIndex += FragSessionData[fragIndex].FragGroupData.FragSize;
@@ -527,3 +603,19 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
         }
     }
 }
+
+static uint8_t GetDecoderSessionId( uint8_t fragIndex )
+{
+    return fragIndex % FRAG_DECODER_MAX_SESSIONS;
+}
+
+#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
+static FragDecoderCallbacks_t* GetDecoderCallbacks( uint8_t fragIndex )
+{
+    if( LmhpFragmentationParams->SessionDecoderCallbacks[fragIndex] != NULL )
+    {
+        return LmhpFragmentationParams->SessionDecoderCallbacks[fragIndex];
+    }
+    return &LmhpFragmentationParams->DecoderCallbacks;
+}
+#endif
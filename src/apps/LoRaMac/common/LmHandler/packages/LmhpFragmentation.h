@@ -34,6 +34,11 @@
  */
 #define PACKAGE_ID_FRAGMENTATION                    3
 
+/*!
+ * Maximum number of fragmentation sessions indexes ( FragIndex )
+ */
+#define FRAGMENTATION_MAX_SESSIONS                  4
+
 /*!
  * Fragmentation package parameters
  */
@@ -44,6 +49,19 @@ typedef struct LmhpFragmentationParams_s
      * FragDecoder Write/Read function callbacks
      */
     FragDecoderCallbacks_t DecoderCallbacks;
+    /*!
+     * Optional FragDecoder Write/Read function callbacks of each
+     * fragmentation session index. \ref DecoderCallbacks is used when NULL.
+     *
+     * \remark Fragmentation sessions are decoded concurrently when
+     *         \ref FRAG_DECODER_MAX_SESSIONS allows it. Each session index
+     *         uses the decoder session ( index % FRAG_DECODER_MAX_SESSIONS )
+     *
+     * \remark The decoder writes each session from storage address 0. A
+     *         session setup is rejected while another ongoing session, on a
+     *         different decoder session, uses the same callbacks
+     */
+    FragDecoderCallbacks_t *SessionDecoderCallbacks[FRAGMENTATION_MAX_SESSIONS];
 #else
     /*!
      * Pointer to the un-fragmented received buffer.
@@ -73,6 +91,17 @@ typedef struct LmhpFragmentationParams_s
      * \param [IN] size   Received file size
      */
     void ( *OnDone )( int32_t status, uint32_t size );
+    /*!
+     * Notifies that the fragmentation session of the given index is finished.
+     * Optional, called instead of \ref OnDone when set
+     *
+     * \param [IN] fragIndex Fragmentation session index
+     * \param [IN] status    Fragmentation session status [FRAG_SESSION_ONGOING,
+     *                                                     FRAG_SESSION_FINISHED or
+     *                                                     FragDecoder.Status.FragNbLost]
+     * \param [IN] size      Received file size
+     */
+    void ( *OnSessionDone )( uint8_t fragIndex, int32_t status, uint32_t size );
 #else
     /*!
      * Notifies that the fragmentation session is finished
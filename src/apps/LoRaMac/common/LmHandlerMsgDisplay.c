@@ -79,7 +79,8 @@ const char* EventInfoStatusStrings[] =
     "Multicast fail",                // LORAMAC_EVENT_INFO_STATUS_MULTICAST_FAIL
     "Beacon locked",                 // LORAMAC_EVENT_INFO_STATUS_BEACON_LOCKED
     "Beacon lost",                   // LORAMAC_EVENT_INFO_STATUS_BEACON_LOST
-    "Beacon not found"               // LORAMAC_EVENT_INFO_STATUS_BEACON_NOT_FOUND
+    "Beacon not found",              // LORAMAC_EVENT_INFO_STATUS_BEACON_NOT_FOUND
+    "Channel busy"                   // LORAMAC_EVENT_INFO_STATUS_CHANNEL_BUSY
 };
 
 /*!
@@ -63,7 +63,9 @@ const struct Radio_s Radio =
     SX1272GetWakeupTime,
     NULL, // void ( *IrqProcess )( void )
     NULL, // void ( *RxBoosted )( uint32_t timeout ) - SX126x Only
-    NULL, // void ( *SetRxDutyCycle )( uint32_t rxTime, uint32_t sleepTime ) - SX126x Only
+    SX1272SetRxDutyCycle,
+    SX1272SetCadParams,
+    SX1272GetIrqTime
 };
 
 /*!
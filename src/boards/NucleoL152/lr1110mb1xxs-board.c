@@ -173,14 +173,8 @@ lr1110_hal_status_t lr1110_hal_write( const void* context, const uint8_t* comman
     if( lr1110_hal_wakeup( context ) == LR1110_HAL_STATUS_OK )
     {
         GpioWrite( &( ( lr1110_t* ) context )->spi.Nss, 0 );
-        for( uint16_t i = 0; i < command_length; i++ )
-        {
-            SpiInOut( &( ( lr1110_t* ) context )->spi, command[i] );
-        }
-        for( uint16_t i = 0; i < data_length; i++ )
-        {
-            SpiInOut( &( ( lr1110_t* ) context )->spi, data[i] );
-        }
+        SpiTransfer( &( ( lr1110_t* ) context )->spi, command, NULL, command_length );
+        SpiTransfer( &( ( lr1110_t* ) context )->spi, data, NULL, data_length );
         GpioWrite( &( ( lr1110_t* ) context )->spi.Nss, 1 );
 
         // 0x011B - LR1110_SYSTEM_SET_SLEEP_OC
@@ -203,10 +197,7 @@ lr1110_hal_status_t lr1110_hal_read( const void* context, const uint8_t* command
     {
         GpioWrite( &( ( lr1110_t* ) context )->spi.Nss, 0 );
 
-        for( uint16_t i = 0; i < command_length; i++ )
-        {
-            SpiInOut( &( ( lr1110_t* ) context )->spi, command[i] );
-        }
+        SpiTransfer( &( ( lr1110_t* ) context )->spi, command, NULL, command_length );
 
         GpioWrite( &( ( lr1110_t* ) context )->spi.Nss, 1 );
 
@@ -217,10 +208,7 @@ lr1110_hal_status_t lr1110_hal_read( const void* context, const uint8_t* command
 
         SpiInOut( &( ( lr1110_t* ) context )->spi, 0 );
 
-        for( uint16_t i = 0; i < data_length; i++ )
-        {
-            data[i] = SpiInOut( &( ( lr1110_t* ) context )->spi, 0 );
-        }
+        SpiTransfer( &( ( lr1110_t* ) context )->spi, NULL, data, data_length );
 
         GpioWrite( &( ( lr1110_t* ) context )->spi.Nss, 1 );
 
@@ -236,10 +224,7 @@ lr1110_hal_status_t lr1110_hal_write_read( const void* context, const uint8_t* c
     {
         GpioWrite( &( ( lr1110_t* ) context )->spi.Nss, 0 );
 
-        for( uint16_t i = 0; i < data_length; i++ )
-        {
-            data[i] = SpiInOut( &( ( lr1110_t* ) context )->spi, command[i] );
-        }
+        SpiTransfer( &( ( lr1110_t* ) context )->spi, command, data, data_length );
 
         GpioWrite( &( ( lr1110_t* ) context )->spi.Nss, 1 );
 
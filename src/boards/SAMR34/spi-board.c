@@ -98,3 +98,30 @@ uint16_t SpiInOut( Spi_t *obj, uint16_t outData )
 
     return outData;
 }
+
+void SpiTransfer( Spi_t *obj, const uint8_t *txBuffer, uint8_t *rxBuffer, uint16_t size )
+{
+    uint8_t rxData;
+
+    for( uint16_t i = 0; i < size; i++ )
+    {
+        // Wait for bus idle (ready to write)
+        while( ( SERCOM_SPI_INTFLAG_DRE & hri_sercomspi_read_INTFLAG_reg( SERCOM4 ) ) == 0 )
+        {
+
+        }
+        hri_sercomspi_write_DATA_reg( SERCOM4, ( txBuffer != NULL ) ? txBuffer[i] : 0 );
+
+        // Wait for ready to read
+        while( ( SERCOM_SPI_INTFLAG_RXC & hri_sercomspi_read_INTFLAG_reg( SERCOM4 ) ) == 0 )
+        {
+
+        }
+        rxData = ( uint8_t )hri_sercomspi_read_DATA_reg( SERCOM4 );
+
+        if( rxBuffer != NULL )
+        {
+            rxBuffer[i] = rxData;
+        }
+    }
+}
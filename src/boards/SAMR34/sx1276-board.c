@@ -74,7 +74,9 @@ const struct Radio_s Radio =
     SX1276GetWakeupTime,
     NULL, // void ( *IrqProcess )( void )
     NULL, // void ( *RxBoosted )( uint32_t timeout ) - SX126x Only
-    NULL, // void ( *SetRxDutyCycle )( uint32_t rxTime, uint32_t sleepTime ) - SX126x Only
+    SX1276SetRxDutyCycle,
+    SX1276SetCadParams,
+    SX1276GetIrqTime
 };
 
 /*!
@@ -163,3 +163,33 @@ uint16_t SpiInOut( Spi_t *obj, uint16_t outData )
     return( rxData );
 }
 
+void SpiTransfer( Spi_t *obj, const uint8_t *txBuffer, uint8_t *rxBuffer, uint16_t size )
+{
+    SPI_TypeDef *spi;
+    uint8_t rxData;
+
+    if( ( obj == NULL ) || ( SpiHandle[obj->SpiId].Instance ) == NULL )
+    {
+        assert_param( LMN_STATUS_ERROR );
+    }
+    spi = SpiHandle[obj->SpiId].Instance;
+
+    __HAL_SPI_ENABLE( &SpiHandle[obj->SpiId] );
+
+    // Only one byte is in flight at a time. An interrupt may stretch the
+    // transfer but can't cause a receive overrun.
+    for( uint16_t i = 0; i < size; i++ )
+    {
+        while( ( spi->SR & SPI_FLAG_TXE ) == 0 );
+        spi->DR = ( txBuffer != NULL ) ? txBuffer[i] : 0;
+
+        while( ( spi->SR & SPI_FLAG_RXNE ) == 0 );
+        rxData = ( uint8_t )spi->DR;
+
+        if( rxBuffer != NULL )
+        {
+            rxBuffer[i] = rxData;
+        }
+    }
+}
+
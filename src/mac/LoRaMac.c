@@ -90,6 +90,31 @@
  */
 #define ADR_ACK_COUNTER_MAX                         0xFFFFFFFF
 
+/*!
+ * Number of reception windows timeouts to collect before the learned wake up
+ * time and timing error are used
+ */
+#define RX_TIMING_MIN_SAMPLES                       8
+
+/*!
+ * Number of bits of the multicast address lookup table index. The table holds
+ * at least twice as many slots as multicast contexts.
+ */
+#if ( LORAMAC_MAX_MC_CTX <= 4 )
+#define MC_ADDR_LUT_BITS                            3
+#elif ( LORAMAC_MAX_MC_CTX <= 8 )
+#define MC_ADDR_LUT_BITS                            4
+#elif ( LORAMAC_MAX_MC_CTX <= 16 )
+#define MC_ADDR_LUT_BITS                            5
+#else
+#define MC_ADDR_LUT_BITS                            6
+#endif
+
+/*!
+ * Number of slots of the multicast address lookup table
+ */
+#define MC_ADDR_LUT_SIZE                            ( 1 << MC_ADDR_LUT_BITS )
+
 /*!
  * LoRaMac internal states
  */
@@ -128,19 +153,38 @@ typedef struct sLoRaMacCtx
     * Current processed transmit message
     */
     LoRaMacMessage_t TxMsg;
-    /*!
-    * Buffer containing the data received by the application.
-    */
-    uint8_t AppData[LORAMAC_PHY_MAXPAYLOAD];
     /*
-    * Size of buffer containing the application data.
+    * Size of the application data. The data itself is stored
+    * in place inside PktBuffer.
     */
     uint8_t AppDataSize;
+    SysTime_t LastTxSysTime;
     /*
-    * Buffer containing the upper layer data.
+    * Time of the last radio TxDone event
     */
-    uint8_t RxPayload[LORAMAC_PHY_MAXPAYLOAD];
-    SysTime_t LastTxSysTime;
+    TimerTime_t TxDoneTime;
+    /*
+    * Time of the last radio RxDone event
+    */
+    TimerTime_t RxDoneTime;
+    /*
+    * Set while the radio RxDone event being processed is kept in the queue.
+    * The indications point into its payload until they are delivered
+    */
+    bool RxDoneEventHeld;
+    /*
+    * Set from the radio RxDone callback until the received frame has been
+    * released. The radio driver buffer holding it must not be overwritten
+    */
+    bool RxBufferHeld;
+    /*
+    * Set when the frame transmission waits for the held frame release
+    */
+    bool TxOnRxBufferRelease;
+    /*
+    * Set while a class C RxError or RxTimeout event is pending
+    */
+    bool RxCErrorEventPending;
     /*
     * LoRaMac internal state
     */
@@ -179,6 +223,31 @@ typedef struct sLoRaMacCtx
     RxConfigParams_t RxWindow1Config;
     RxConfigParams_t RxWindow2Config;
     RxConfigParams_t RxWindowCConfig;
+    /*
+    * LoRaMac Rx window C sniff mode configuration
+    */
+    RxCSniffParams_t RxCSniff;
+    /*
+    * LoRaMac listen before talk with CAD configuration
+    */
+    LbtCadParams_t LbtCad;
+    /*
+    * Number of CAD performed for the current uplink
+    */
+    uint8_t LbtCadAttempts;
+    /*
+    * LoRaMac listen before talk back-off timer
+    */
+    TimerEvent_t LbtCadTimer;
+    /*
+    * Reception windows timing statistics
+    */
+    RxTimingStats_t RxTimingStats;
+    /*
+    * Wake up time smoothed average [ms / 8] and mean deviation [ms / 4]
+    */
+    int32_t RxTimingWakeUpAvg;
+    int32_t RxTimingWakeUpDev;
     /*
      * Limit of uplinks without any donwlink response before the ADRACKReq bit will be set.
      */
@@ -281,6 +350,11 @@ typedef struct sLoRaMacCtx
      * Buffer containing the MAC layer commands
      */
     uint8_t MacCommandsBuffer[LORA_MAC_COMMAND_MAX_LENGTH];
+    /*
+     * Open addressed lookup table from multicast address to multicast
+     * context. Each slot holds the multicast index + 1, 0 marks an empty slot.
+     */
+    uint8_t McAddrLut[MC_ADDR_LUT_SIZE];
 }LoRaMacCtx_t;
 
 /*
@@ -293,26 +367,19 @@ static LoRaMacNvmData_t Nvm;
 static Band_t RegionBands[REGION_NVM_MAX_NB_BANDS];
 
 /*!
- * Defines the LoRaMac radio events status
+ * LoRaMac radio events queue
  */
-typedef union uLoRaMacRadioEvents
-{
-    uint32_t Value;
-    struct sEvents
-    {
-        uint32_t RxProcessPending : 1;
-        uint32_t RxTimeout        : 1;
-        uint32_t RxError          : 1;
-        uint32_t TxTimeout        : 1;
-        uint32_t RxDone           : 1;
-        uint32_t TxDone           : 1;
-    }Events;
-}LoRaMacRadioEvents_t;
+static RadioEventQueue_t LoRaMacRadioEvents;
 
-/*!
- * LoRaMac radio events status
+/*
+ * A TX/RX cycle posts at most one event per radio operation ( CAD, TX, RX1,
+ * RX2, RX C ) and the class C RxError and RxTimeout events are coalesced. No
+ * reception is started while a received frame is held, hence the queue cannot
+ * overflow.
  */
-LoRaMacRadioEvents_t LoRaMacRadioEvents = { .Value = 0 };
+#if ( RADIO_EVENT_QUEUE_SIZE < 8 )
+#error "RADIO_EVENT_QUEUE_SIZE must be greater than or equal to 8"
+#endif
 
 /*!
  * \brief Function to be executed on Radio Tx Done event
@@ -345,11 +412,21 @@ static void OnRadioRxError( void );
  */
 static void OnRadioRxTimeout( void );
 
+/*!
+ * \brief Function executed on Radio CAD Done event
+ */
+static void OnRadioCadDone( bool channelActivityDetected );
+
 /*!
  * \brief Function executed on duty cycle delayed Tx  timer event
  */
 static void OnTxDelayedTimerEvent( void* context );
 
+/*!
+ * \brief Function executed on listen before talk back-off timer event
+ */
+static void OnLbtCadTimerEvent( void* context );
+
 /*!
  * \brief Function executed on first Rx window timer event
  */
@@ -407,6 +484,30 @@ static void SetMlmeScheduleUplinkIndication( void );
 static LoRaMacCryptoStatus_t GetFCntDown( AddressIdentifier_t addrID, FType_t fType, LoRaMacMessageData_t* macMsg, Version_t lrWanVersion,
                                           FCntIdentifier_t* fCntID, uint32_t* currentDown );
 
+/*!
+ * \brief Computes the multicast address lookup table slot of an address.
+ *
+ * \param [IN] address Multicast address
+ *
+ * \retval Lookup table slot
+ */
+static uint8_t McAddrLutHash( uint32_t address );
+
+/*!
+ * \brief Rebuilds the multicast address lookup table from the enabled
+ *        multicast channels.
+ */
+static void McAddrLutBuild( void );
+
+/*!
+ * \brief Searches the enabled multicast channel using the given address.
+ *
+ * \param [IN] address Multicast address
+ *
+ * \retval Multicast context. NULL if no enabled channel uses the address.
+ */
+static MulticastCtx_t* McAddrLutFind( uint32_t address );
+
 /*!
  * \brief Switches the device class
  *
@@ -485,6 +586,18 @@ LoRaMacStatus_t SendReJoinReq( JoinReqIdentifier_t joinReqType );
  */
 LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl, uint8_t fPort, void* fBuffer, uint16_t fBufferSize );
 
+/*!
+ * \brief Copies the application data to its final position inside PktBuffer.
+ *        The FRMPayload gets encrypted and authenticated in place afterwards.
+ *
+ * \remark The FOptsLen field of TxMsg must already be set up.
+ *
+ * \param [IN] fBuffer     MAC data buffer to be sent
+ * \param [IN] fBufferSize MAC data buffer size
+ * \retval status          Status of the operation.
+ */
+static LoRaMacStatus_t SetupFrmPayload( void* fBuffer, uint16_t fBufferSize );
+
 /*
  * \brief Schedules the frame according to the duty cycle
  *
@@ -574,6 +687,70 @@ static void RxWindowSetup( TimerEvent_t* rxTimer, RxConfigParams_t* rxConfig );
  */
 static void OpenContinuousRxCWindow( void );
 
+/*!
+ * \brief Computes the radio duty cycle of the RX C window in sniff mode
+ *
+ * \param [OUT] rxTime    Listen window duration [15.625 us steps]
+ * \param [OUT] sleepTime Sleep duration between listen windows [15.625 us steps]
+ *
+ * \retval true if the radio can sleep between the listen windows
+ */
+static bool ComputeRxCSniffWindows( uint32_t* rxTime, uint32_t* sleepTime );
+
+/*!
+ * \brief Verifies if the next uplink is preceded by a listen before talk
+ *        with channel activity detection
+ *
+ * \retval true if enabled and the current datarate uses the LoRa modem
+ */
+static bool IsLbtCadActive( void );
+
+/*!
+ * \brief Gets the preamble length of the next uplink
+ *
+ * \retval preambleLength Preamble length [symbols]
+ */
+static uint16_t GetTxPreambleLength( void );
+
+/*!
+ * \brief Starts a channel activity detection on the configured Tx channel
+ */
+static void StartLbtCad( void );
+
+/*!
+ * \brief Gets the time of the last radio interrupt
+ *
+ * \retval time Time of the last radio interrupt, or the current time if the
+ *              radio does not capture it [ms]
+ */
+static TimerTime_t GetRadioIrqTime( void );
+
+/*!
+ * \brief Gets the LoRa symbol time of a datarate
+ *
+ * \param [IN]  datarate    Datarate
+ * \param [OUT] tSymbolInUs Symbol time [us]
+ *
+ * \retval true if the datarate uses the LoRa modem
+ */
+static bool GetLoRaSymbolTime( int8_t datarate, uint32_t* tSymbolInUs );
+
+/*!
+ * \brief Learns the wake up time from the timeout of the current Rx1 or Rx2 window
+ *
+ * \param [IN] rxTimeoutTime Time of the radio RxTimeout event
+ */
+static void UpdateRxTimingWakeUp( TimerTime_t rxTimeoutTime );
+
+/*!
+ * \brief Updates the margin statistics from a downlink accepted in the
+ *        current Rx1 or Rx2 window. Frames failing the address or MIC
+ *        checks must not be accounted
+ *
+ * \param [IN] size Received payload size
+ */
+static void UpdateRxTimingMargin( uint16_t size );
+
 /*!
  * \brief   Returns a pointer to the internal contexts structure.
  *
@@ -736,83 +913,120 @@ static void LoRaMacHandleNvm( LoRaMacNvmData_t* nvmData );
 static bool LoRaMacHandleResponseTimeout( TimerTime_t timeoutInMs, TimerTime_t startTimeInMs );
 
 /*!
- * Structure used to store the radio Tx event data
+ * \brief Timestamps a radio event and posts it to the LoRaMac radio events queue
+ *
+ * \param [IN] event Radio event
  */
-struct
+static void PostRadioEvent( RadioEvent_t *event )
 {
-    TimerTime_t CurTime;
-}TxDoneParams;
+    event->Time = GetRadioIrqTime( );
+
+    // The SX127x drivers call the radio callbacks from the DIO and the timer
+    // interrupts, which may preempt each other
+    CRITICAL_SECTION_BEGIN( );
+    if( ( event->Type == RADIO_EVENT_RX_ERROR ) || ( event->Type == RADIO_EVENT_RX_TIMEOUT ) )
+    {
+        if( ( MacCtx.RxSlot == RX_SLOT_WIN_CLASS_C ) || ( MacCtx.RxSlot == RX_SLOT_WIN_CLASS_C_MULTICAST ) )
+        {
+            if( MacCtx.RxCErrorEventPending == true )
+            {
+                // The continuous reception keeps going, one event is enough
+                CRITICAL_SECTION_END( );
+                return;
+            }
+            MacCtx.RxCErrorEventPending = true;
+        }
+    }
+    RadioEventQueuePost( &LoRaMacRadioEvents, event );
+    CRITICAL_SECTION_END( );
+
+    if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
+    {
+        MacCtx.MacCallbacks->MacProcessNotify( );
+    }
+}
 
 /*!
- * Structure used to store the radio Rx event data
+ * \brief Removes the held radio RxDone event once its indications have been
+ *        delivered and releases the radio buffer
  */
-struct
-{
-    TimerTime_t LastRxDone;
-    uint8_t *Payload;
-    uint16_t Size;
-    int16_t Rssi;
-    int8_t Snr;
-}RxDoneParams;
-
-static void OnRadioTxDone( void )
+static void ReleaseRadioRxDoneEvent( void )
 {
-    TxDoneParams.CurTime = TimerGetCurrentTime( );
-    MacCtx.LastTxSysTime = SysTimeGet( );
+    if( MacCtx.RxDoneEventHeld == false )
+    {
+        return;
+    }
+    MacCtx.RxDoneEventHeld = false;
+    MacCtx.RxBufferHeld = false;
+    RadioEventQueueRemove( &LoRaMacRadioEvents );
 
-    LoRaMacRadioEvents.Events.TxDone = 1;
+    if( MacCtx.TxOnRxBufferRelease == true )
+    {
+        MacCtx.TxOnRxBufferRelease = false;
+        Radio.Send( MacCtx.PktBuffer, MacCtx.PktBufferLen );
+    }
 
-    if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
+    // The remaining events and the class B slots are processed by the next
+    // LoRaMacProcess call
+    if( ( ( RadioEventQueueIsEmpty( &LoRaMacRadioEvents ) == false ) ||
+          ( LoRaMacClassBHasPendingEvents( ) == true ) ) &&
+        ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
     {
         MacCtx.MacCallbacks->MacProcessNotify( );
     }
 }
 
+static void OnRadioTxDone( void )
+{
+    RadioEvent_t event = { .Type = RADIO_EVENT_TX_DONE };
+
+    MacCtx.LastTxSysTime = SysTimeGet( );
+    PostRadioEvent( &event );
+}
+
 static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr )
 {
-    RxDoneParams.LastRxDone = TimerGetCurrentTime( );
-    RxDoneParams.Payload = payload;
-    RxDoneParams.Size = size;
-    RxDoneParams.Rssi = rssi;
-    RxDoneParams.Snr = snr;
+    RadioEvent_t event = { .Type = RADIO_EVENT_RX_DONE };
 
-    LoRaMacRadioEvents.Events.RxDone = 1;
-    LoRaMacRadioEvents.Events.RxProcessPending = 1;
+    event.Payload = payload;
+    event.Size = size;
+    event.Rssi = rssi;
+    event.Snr = snr;
 
-    if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
-    {
-        MacCtx.MacCallbacks->MacProcessNotify( );
-    }
+    // The payload is processed in place. Stop a continuous reception, which
+    // would overwrite it, until the frame is released
+    Radio.Sleep( );
+    MacCtx.RxBufferHeld = true;
+    PostRadioEvent( &event );
 }
 
 static void OnRadioTxTimeout( void )
 {
-    LoRaMacRadioEvents.Events.TxTimeout = 1;
+    RadioEvent_t event = { .Type = RADIO_EVENT_TX_TIMEOUT };
 
-    if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
-    {
-        MacCtx.MacCallbacks->MacProcessNotify( );
-    }
+    PostRadioEvent( &event );
 }
 
 static void OnRadioRxError( void )
 {
-    LoRaMacRadioEvents.Events.RxError = 1;
+    RadioEvent_t event = { .Type = RADIO_EVENT_RX_ERROR };
 
-    if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
-    {
-        MacCtx.MacCallbacks->MacProcessNotify( );
-    }
+    PostRadioEvent( &event );
 }
 
 static void OnRadioRxTimeout( void )
 {
-    LoRaMacRadioEvents.Events.RxTimeout = 1;
+    RadioEvent_t event = { .Type = RADIO_EVENT_RX_TIMEOUT };
 
-    if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
-    {
-        MacCtx.MacCallbacks->MacProcessNotify( );
-    }
+    PostRadioEvent( &event );
+}
+
+static void OnRadioCadDone( bool channelActivityDetected )
+{
+    RadioEvent_t event = { .Type = RADIO_EVENT_CAD_DONE };
+
+    event.ChannelActivityDetected = channelActivityDetected;
+    PostRadioEvent( &event );
 }
 
 static void UpdateRxSlotIdleState( void )
@@ -827,20 +1041,30 @@ static void UpdateRxSlotIdleState( void )
     }
 }
 
-static void ProcessRadioTxDone( void )
+static void ProcessRadioTxDone( RadioEvent_t *event )
 {
     GetPhyParams_t getPhy;
     PhyParam_t phyParam;
     SetBandTxDoneParams_t txDone;
+    TimerTime_t elapsedTime = 0;
+
+    MacCtx.TxDoneTime = event->Time;
+    elapsedTime = TimerGetElapsedTime( MacCtx.TxDoneTime );
 
     if( Nvm.MacGroup2.DeviceClass != CLASS_C )
     {
         Radio.Sleep( );
     }
-    // Setup timers
-    TimerSetValue( &MacCtx.RxWindowTimer1, MacCtx.RxWindow1Delay );
+    else
+    {
+        // Re-open the RX C window, which may have been closed by the listen before talk
+        MacCtx.RxSlot = RX_SLOT_WIN_CLASS_C;
+    }
+    // Setup timers. The delays start at the TxDone interrupt, which may have
+    // occurred some time before this event is processed.
+    TimerSetValue( &MacCtx.RxWindowTimer1, ( MacCtx.RxWindow1Delay > elapsedTime ) ? ( MacCtx.RxWindow1Delay - elapsedTime ) : 1 );
     TimerStart( &MacCtx.RxWindowTimer1 );
-    TimerSetValue( &MacCtx.RxWindowTimer2, MacCtx.RxWindow2Delay );
+    TimerSetValue( &MacCtx.RxWindowTimer2, ( MacCtx.RxWindow2Delay > elapsedTime ) ? ( MacCtx.RxWindow2Delay - elapsedTime ) : 1 );
     TimerStart( &MacCtx.RxWindowTimer2 );
 
     if( MacCtx.NodeAckRequested == true )
@@ -857,11 +1081,11 @@ static void ProcessRadioTxDone( void )
     }
 
     // Update Aggregated last tx done time
-    Nvm.MacGroup1.LastTxDoneTime = TxDoneParams.CurTime;
+    Nvm.MacGroup1.LastTxDoneTime = MacCtx.TxDoneTime;
 
     // Update last tx done time for the current channel
     txDone.Channel = MacCtx.Channel;
-    txDone.LastTxDoneTime = TxDoneParams.CurTime;
+    txDone.LastTxDoneTime = MacCtx.TxDoneTime;
     txDone.ElapsedTimeSinceStartUp = SysTimeSub( SysTimeGetMcuTime( ), Nvm.MacGroup2.InitializationTime );
     txDone.LastTxAirTime = MacCtx.TxTimeOnAir;
     txDone.Joined  = true;
@@ -888,7 +1112,7 @@ static void PrepareRxDoneAbort( void )
     UpdateRxSlotIdleState( );
 }
 
-static void ProcessRadioRxDone( void )
+static void ProcessRadioRxDone( RadioEvent_t *event )
 {
     LoRaMacHeader_t macHdr;
     ApplyCFListParams_t applyCFList;
@@ -898,10 +1122,10 @@ static void ProcessRadioRxDone( void )
 
     LoRaMacMessageData_t macMsgData;
     LoRaMacMessageJoinAccept_t macMsgJoinAccept;
-    uint8_t *payload = RxDoneParams.Payload;
-    uint16_t size = RxDoneParams.Size;
-    int16_t rssi = RxDoneParams.Rssi;
-    int8_t snr = RxDoneParams.Snr;
+    uint8_t *payload = event->Payload;
+    uint16_t size = event->Size;
+    int16_t rssi = event->Rssi;
+    int8_t snr = event->Snr;
 
     uint8_t pktHeaderLen = 0;
 
@@ -912,7 +1136,7 @@ static void ProcessRadioRxDone( void )
     FCntIdentifier_t fCntID;
     uint8_t macCmdPayload[2] = { 0 };
 
-    LoRaMacRadioEvents.Events.RxProcessPending = 0;
+    MacCtx.RxDoneTime = event->Time;
 
     MacCtx.McpsConfirm.AckReceived = false;
     MacCtx.McpsIndication.Rssi = rssi;
@@ -939,7 +1163,7 @@ static void ProcessRadioRxDone( void )
     }
 
     // This function must be called even if we are not in class b mode yet.
-    if( LoRaMacClassBRxBeacon( payload, size ) == true )
+    if( LoRaMacClassBRxBeacon( payload, size, MacCtx.RxDoneTime ) == true )
     {
         MacCtx.MlmeIndication.BeaconInfo.Rssi = rssi;
         MacCtx.MlmeIndication.BeaconInfo.Snr = snr;
@@ -996,6 +1220,8 @@ static void ProcessRadioRxDone( void )
 
             if( LORAMAC_CRYPTO_SUCCESS == macCryptoStatus )
             {
+                UpdateRxTimingMargin( size );
+
                 // Network ID
                 Nvm.MacGroup2.NetID = ( uint32_t ) macMsgJoinAccept.NetID[0];
                 Nvm.MacGroup2.NetID |= ( ( uint32_t ) macMsgJoinAccept.NetID[1] << 8 );
@@ -1087,10 +1313,10 @@ static void ProcessRadioRxDone( void )
                 PrepareRxDoneAbort( );
                 return;
             }
+            // The frame is parsed and decrypted in place. FRMPayload points into the
+            // radio receive buffer.
             macMsgData.Buffer = payload;
             macMsgData.BufSize = size;
-            macMsgData.FRMPayload = MacCtx.RxPayload;
-            macMsgData.FRMPayloadSize = LORAMAC_PHY_MAXPAYLOAD;
 
             if( LORAMAC_PARSER_SUCCESS != LoRaMacParserData( &macMsgData ) )
             {
@@ -1133,20 +1359,16 @@ static void ProcessRadioRxDone( void )
             //Check if it is a multicast message
             multicast = 0;
             downLinkCounter = 0;
-            for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
-            {
-                if( ( Nvm.MacGroup2.MulticastChannelList[i].ChannelParams.Address == macMsgData.FHDR.DevAddr ) &&
-                    ( Nvm.MacGroup2.MulticastChannelList[i].ChannelParams.IsEnabled == true ) )
+            MulticastCtx_t* mcCtx = McAddrLutFind( macMsgData.FHDR.DevAddr );
+            if( mcCtx != NULL )
+            {
+                multicast = 1;
+                addrID = mcCtx->ChannelParams.GroupID;
+                downLinkCounter = *( mcCtx->DownLinkCounter );
+                address = mcCtx->ChannelParams.Address;
+                if( Nvm.MacGroup2.DeviceClass == CLASS_C )
                 {
-                    multicast = 1;
-                    addrID = Nvm.MacGroup2.MulticastChannelList[i].ChannelParams.GroupID;
-                    downLinkCounter = *( Nvm.MacGroup2.MulticastChannelList[i].DownLinkCounter );
-                    address = Nvm.MacGroup2.MulticastChannelList[i].ChannelParams.Address;
-                    if( Nvm.MacGroup2.DeviceClass == CLASS_C )
-                    {
-                        MacCtx.McpsIndication.RxSlot = RX_SLOT_WIN_CLASS_C_MULTICAST;
-                    }
-                    break;
+                    MacCtx.McpsIndication.RxSlot = RX_SLOT_WIN_CLASS_C_MULTICAST;
                 }
             }
 
@@ -1196,6 +1418,8 @@ static void ProcessRadioRxDone( void )
                 return;
             }
 
+            UpdateRxTimingMargin( size );
+
             MacCtx.McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_OK;
             MacCtx.McpsIndication.Multicast = multicast;
             MacCtx.McpsIndication.FramePending = macMsgData.FHDR.FCtrl.Bits.FPending;
@@ -1237,7 +1461,7 @@ static void ProcessRadioRxDone( void )
                     {
                         // Calculate timeout
                         MacCtx.McpsIndication.ResponseTimeout = REGION_COMMON_CLASS_B_C_RESP_TIMEOUT;
-                        MacCtx.ResponseTimeoutStartTime = RxDoneParams.LastRxDone;
+                        MacCtx.ResponseTimeoutStartTime = MacCtx.RxDoneTime;
                     }
                 }
                 else
@@ -1344,11 +1568,9 @@ static void ProcessRadioRxDone( void )
 
             break;
         case FRAME_TYPE_PROPRIETARY:
-            memcpy1( MacCtx.RxPayload, &payload[pktHeaderLen], size - pktHeaderLen );
-
             MacCtx.McpsIndication.McpsIndication = MCPS_PROPRIETARY;
             MacCtx.McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_OK;
-            MacCtx.McpsIndication.Buffer = MacCtx.RxPayload;
+            MacCtx.McpsIndication.Buffer = &payload[pktHeaderLen];
             MacCtx.McpsIndication.BufferSize = size - pktHeaderLen;
 
             MacCtx.MacFlags.Bits.McpsInd = 1;
@@ -1398,6 +1620,37 @@ static void ProcessRadioTxTimeout( void )
     MacCtx.MacFlags.Bits.MacDone = 1;
 }
 
+static void ProcessRadioCadDone( RadioEvent_t *event )
+{
+    if( event->ChannelActivityDetected == false )
+    {
+        // The channel is free, send now
+        Radio.Send( MacCtx.PktBuffer, MacCtx.PktBufferLen );
+        return;
+    }
+
+    Radio.Sleep( );
+
+    if( MacCtx.LbtCadAttempts < MacCtx.LbtCad.MaxAttempts )
+    {
+        // The channel is busy, retry after a random back-off of up to the frame time on air
+        TimerSetValue( &MacCtx.LbtCadTimer, randr( 1, MAX( MacCtx.TxTimeOnAir, 1 ) ) );
+        TimerStart( &MacCtx.LbtCadTimer );
+        return;
+    }
+
+    // The channel has been busy during all the attempts. Handled like a Tx timeout.
+    UpdateRxSlotIdleState( );
+
+    MacCtx.McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_CHANNEL_BUSY;
+    LoRaMacConfirmQueueSetStatusCmn( LORAMAC_EVENT_INFO_STATUS_CHANNEL_BUSY );
+    if( MacCtx.NodeAckRequested == true )
+    {
+        MacCtx.RetransmitTimeoutRetry = true;
+    }
+    MacCtx.MacFlags.Bits.MacDone = 1;
+}
+
 static void HandleRadioRxErrorTimeout( LoRaMacEventInfoStatus_t rx1EventInfoStatus, LoRaMacEventInfoStatus_t rx2EventInfoStatus )
 {
     bool classBRx = false;
@@ -1464,48 +1717,71 @@ static void ProcessRadioRxError( void )
     HandleRadioRxErrorTimeout( LORAMAC_EVENT_INFO_STATUS_RX1_ERROR, LORAMAC_EVENT_INFO_STATUS_RX2_ERROR );
 }
 
-static void ProcessRadioRxTimeout( void )
+static void ProcessRadioRxTimeout( RadioEvent_t *event )
 {
+    if( ( MacCtx.RxSlot == RX_SLOT_WIN_1 ) || ( MacCtx.RxSlot == RX_SLOT_WIN_2 ) )
+    {
+        UpdateRxTimingWakeUp( event->Time );
+    }
     HandleRadioRxErrorTimeout( LORAMAC_EVENT_INFO_STATUS_RX1_TIMEOUT, LORAMAC_EVENT_INFO_STATUS_RX2_TIMEOUT );
 }
 
 static void LoRaMacHandleIrqEvents( void )
 {
-    LoRaMacRadioEvents_t events;
-
-    CRITICAL_SECTION_BEGIN( );
-    events = LoRaMacRadioEvents;
-    LoRaMacRadioEvents.Value = 0;
-    CRITICAL_SECTION_END( );
+    RadioEvent_t *event;
 
-    if( events.Value != 0 )
+    // Process the radio events in the order they occurred
+    while( ( MacCtx.RxDoneEventHeld == false ) &&
+           ( ( event = RadioEventQueuePeek( &LoRaMacRadioEvents ) ) != NULL ) )
     {
-        if( events.Events.TxDone == 1 )
-        {
-            ProcessRadioTxDone( );
-        }
-        if( events.Events.RxDone == 1 )
+        switch( event->Type )
         {
-            ProcessRadioRxDone( );
-        }
-        if( events.Events.TxTimeout == 1 )
-        {
-            ProcessRadioTxTimeout( );
-        }
-        if( events.Events.RxError == 1 )
-        {
-            ProcessRadioRxError( );
-        }
-        if( events.Events.RxTimeout == 1 )
-        {
-            ProcessRadioRxTimeout( );
+            case RADIO_EVENT_TX_DONE:
+            {
+                ProcessRadioTxDone( event );
+                break;
+            }
+            case RADIO_EVENT_RX_DONE:
+            {
+                ProcessRadioRxDone( event );
+                // The indications refer to the event payload. The draining
+                // resumes once they have been delivered
+                MacCtx.RxDoneEventHeld = true;
+                continue;
+            }
+            case RADIO_EVENT_TX_TIMEOUT:
+            {
+                ProcessRadioTxTimeout( );
+                break;
+            }
+            case RADIO_EVENT_RX_ERROR:
+            {
+                MacCtx.RxCErrorEventPending = false;
+                ProcessRadioRxError( );
+                break;
+            }
+            case RADIO_EVENT_RX_TIMEOUT:
+            {
+                MacCtx.RxCErrorEventPending = false;
+                ProcessRadioRxTimeout( event );
+                break;
+            }
+            case RADIO_EVENT_CAD_DONE:
+            {
+                ProcessRadioCadDone( event );
+                break;
+            }
+            default:
+                break;
         }
+        RadioEventQueueRemove( &LoRaMacRadioEvents );
     }
 }
 
 bool LoRaMacIsBusy( void )
 {
-    if( LoRaMacRadioEvents.Events.RxProcessPending == 1 )
+    // A received frame is waiting to be processed
+    if( ( MacCtx.RxBufferHeld == true ) && ( MacCtx.RxDoneEventHeld == false ) )
     {
         return true;
     }
@@ -1519,6 +1795,40 @@ bool LoRaMacIsBusy( void )
 }
 
 
+bool LoRaMacHasPendingWork( void )
+{
+    LoRaMacFlags_t pendingFlags = { .Value = 0 };
+
+    if( RadioEventQueueIsEmpty( &LoRaMacRadioEvents ) == false )
+    {
+        return true;
+    }
+
+    if( LoRaMacClassBHasPendingEvents( ) == true )
+    {
+        return true;
+    }
+
+    // The request flags remain set during the whole TX/RX cycle.
+    // Only the flags triggering a processing step are considered.
+    pendingFlags.Bits.McpsInd = 1;
+    pendingFlags.Bits.MlmeInd = 1;
+    pendingFlags.Bits.MlmeSchedUplinkInd = 1;
+    pendingFlags.Bits.MacDone = 1;
+    pendingFlags.Bits.NvmHandle = 1;
+    if( ( MacCtx.MacFlags.Value & pendingFlags.Value ) != 0 )
+    {
+        return true;
+    }
+
+    // Class C continuous reception window has to be re-opened
+    if( ( MacCtx.RxSlot == RX_SLOT_WIN_CLASS_C ) && ( Radio.GetStatus( ) == RF_IDLE ) )
+    {
+        return true;
+    }
+    return false;
+}
+
 static void LoRaMacEnableRequests( LoRaMacRequestHandling_t requestState )
 {
     MacCtx.AllowRequests = requestState;
@@ -1805,8 +2115,18 @@ void LoRaMacProcess( void )
 {
     uint8_t noTx = false;
 
+    if( LoRaMacHasPendingWork( ) == false )
+    {
+        // Nothing to be done, the MCU may return to low power mode
+        return;
+    }
+
     LoRaMacHandleIrqEvents( );
-    LoRaMacClassBProcess( );
+    if( MacCtx.RxBufferHeld == false )
+    {
+        // The class B slots are opened once the held frame has been released
+        LoRaMacClassBProcess( );
+    }
 
     // MAC proceeded a state and is ready to check
     if( MacCtx.MacFlags.Bits.MacDone == 1 )
@@ -1831,6 +2151,7 @@ void LoRaMacProcess( void )
         MacCtx.MacFlags.Bits.NvmHandle = 1;
     }
     LoRaMacHandleIndicationEvents( );
+    ReleaseRadioRxDoneEvent( );
     if( MacCtx.RxSlot == RX_SLOT_WIN_CLASS_C )
     {
         OpenContinuousRxCWindow( );
@@ -1875,12 +2196,20 @@ static void OnTxDelayedTimerEvent( void* context )
     }
 }
 
+static void OnLbtCadTimerEvent( void* context )
+{
+    TimerStop( &MacCtx.LbtCadTimer );
+
+    StartLbtCad( );
+}
+
 static void OnRxWindow1TimerEvent( void* context )
 {
     MacCtx.RxWindow1Config.Channel = MacCtx.Channel;
     MacCtx.RxWindow1Config.DrOffset = Nvm.MacGroup2.MacParams.Rx1DrOffset;
     MacCtx.RxWindow1Config.DownlinkDwellTime = Nvm.MacGroup2.MacParams.DownlinkDwellTime;
     MacCtx.RxWindow1Config.RxContinuous = false;
+    MacCtx.RxWindow1Config.PreambleLength = REGION_COMMON_DEFAULT_PREAMBLE_LENGTH;
     MacCtx.RxWindow1Config.RxSlot = RX_SLOT_WIN_1;
     MacCtx.RxWindow1Config.NetworkActivation = Nvm.MacGroup2.NetworkActivation;
 
@@ -1899,6 +2228,7 @@ static void OnRxWindow2TimerEvent( void* context )
     MacCtx.RxWindow2Config.Frequency = Nvm.MacGroup2.MacParams.Rx2Channel.Frequency;
     MacCtx.RxWindow2Config.DownlinkDwellTime = Nvm.MacGroup2.MacParams.DownlinkDwellTime;
     MacCtx.RxWindow2Config.RxContinuous = false;
+    MacCtx.RxWindow2Config.PreambleLength = REGION_COMMON_DEFAULT_PREAMBLE_LENGTH;
     MacCtx.RxWindow2Config.RxSlot = RX_SLOT_WIN_2;
     MacCtx.RxWindow2Config.NetworkActivation = Nvm.MacGroup2.NetworkActivation;
 
@@ -1948,25 +2278,62 @@ static LoRaMacCryptoStatus_t GetFCntDown( AddressIdentifier_t addrID, FType_t fT
                 *fCntID = FCNT_DOWN;
             }
             break;
-        case MULTICAST_0_ADDR:
-            *fCntID = MC_FCNT_DOWN_0;
-            break;
-        case MULTICAST_1_ADDR:
-            *fCntID = MC_FCNT_DOWN_1;
-            break;
-        case MULTICAST_2_ADDR:
-            *fCntID = MC_FCNT_DOWN_2;
-            break;
-        case MULTICAST_3_ADDR:
-            *fCntID = MC_FCNT_DOWN_3;
-            break;
         default:
-            return LORAMAC_CRYPTO_FAIL_FCNT_ID;
+            if( addrID >= LORAMAC_MAX_MC_CTX )
+            {
+                return LORAMAC_CRYPTO_FAIL_FCNT_ID;
+            }
+            *fCntID = LORAMAC_MC_FCNT_DOWN_ID( addrID );
+            break;
     }
 
     return LoRaMacCryptoGetFCntDown( *fCntID, macMsg->FHDR.FCnt, currentDown );
 }
 
+static uint8_t McAddrLutHash( uint32_t address )
+{
+    // Fibonacci hashing, keeps the upper bits of the product
+    return ( uint8_t )( ( uint32_t )( address * 0x9E3779B1UL ) >> ( 32 - MC_ADDR_LUT_BITS ) );
+}
+
+static void McAddrLutBuild( void )
+{
+    memset1( MacCtx.McAddrLut, 0, sizeof( MacCtx.McAddrLut ) );
+
+    for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+    {
+        if( Nvm.MacGroup2.MulticastChannelList[i].ChannelParams.IsEnabled == false )
+        {
+            continue;
+        }
+        uint8_t slot = McAddrLutHash( Nvm.MacGroup2.MulticastChannelList[i].ChannelParams.Address );
+        // The table always has free slots, linear probing terminates
+        while( MacCtx.McAddrLut[slot] != 0 )
+        {
+            slot = ( slot + 1 ) & ( MC_ADDR_LUT_SIZE - 1 );
+        }
+        MacCtx.McAddrLut[slot] = i + 1;
+    }
+}
+
+static MulticastCtx_t* McAddrLutFind( uint32_t address )
+{
+    uint8_t slot = McAddrLutHash( address );
+
+    while( MacCtx.McAddrLut[slot] != 0 )
+    {
+        MulticastCtx_t* mcCtx = &Nvm.MacGroup2.MulticastChannelList[MacCtx.McAddrLut[slot] - 1];
+
+        if( ( mcCtx->ChannelParams.Address == address ) &&
+            ( mcCtx->ChannelParams.IsEnabled == true ) )
+        {
+            return mcCtx;
+        }
+        slot = ( slot + 1 ) & ( MC_ADDR_LUT_SIZE - 1 );
+    }
+    return NULL;
+}
+
 static LoRaMacStatus_t SwitchClass( DeviceClass_t deviceClass )
 {
     LoRaMacStatus_t status = LORAMAC_STATUS_PARAMETER_INVALID;
@@ -2586,7 +2953,7 @@ static void ProcessMacCommands( uint8_t *payload, uint8_t macIndex, uint8_t comm
                     beaconTimingDelay |= ( uint16_t )payload[macIndex++] << 8;
                     beaconTimingChannel = payload[macIndex++];
 
-                    LoRaMacClassBBeaconTimingAns( beaconTimingDelay, beaconTimingChannel, RxDoneParams.LastRxDone );
+                    LoRaMacClassBBeaconTimingAns( beaconTimingDelay, beaconTimingChannel, MacCtx.RxDoneTime );
                 }
                 break;
             }
@@ -2822,6 +3189,16 @@ static LoRaMacStatus_t CheckForClassBCollision( void )
 
 static void ComputeRxWindowParameters( void )
 {
+    uint32_t rxError = Nvm.MacGroup2.MacParams.SystemMaxRxError;
+    int32_t wakeUpCorrection = 0;
+
+    if( MacCtx.RxTimingStats.NbWakeUpSamples >= RX_TIMING_MIN_SAMPLES )
+    {
+        // Use the learned timing instead of the worst case values
+        rxError = MIN( MacCtx.RxTimingStats.RxError, rxError );
+        wakeUpCorrection = ( int32_t )Radio.GetWakeupTime( ) - ( int32_t )MacCtx.RxTimingStats.WakeUpTime;
+    }
+
     // Compute Rx1 windows parameters
     RegionComputeRxWindowParameters( Nvm.MacGroup2.Region,
                                      RegionApplyDrOffset( Nvm.MacGroup2.Region,
@@ -2829,15 +3206,19 @@ static void ComputeRxWindowParameters( void )
                                                           Nvm.MacGroup1.ChannelsDatarate,
                                                           Nvm.MacGroup2.MacParams.Rx1DrOffset ),
                                      Nvm.MacGroup2.MacParams.MinRxSymbols,
-                                     Nvm.MacGroup2.MacParams.SystemMaxRxError,
+                                     rxError,
                                      &MacCtx.RxWindow1Config );
     // Compute Rx2 windows parameters
     RegionComputeRxWindowParameters( Nvm.MacGroup2.Region,
                                      Nvm.MacGroup2.MacParams.Rx2Channel.Datarate,
                                      Nvm.MacGroup2.MacParams.MinRxSymbols,
-                                     Nvm.MacGroup2.MacParams.SystemMaxRxError,
+                                     rxError,
                                      &MacCtx.RxWindow2Config );
 
+    // The regions compute the offsets with Radio.GetWakeupTime
+    MacCtx.RxWindow1Config.WindowOffset += wakeUpCorrection;
+    MacCtx.RxWindow2Config.WindowOffset += wakeUpCorrection;
+
     // Default setup, in case the device joined
     MacCtx.RxWindow1Delay = Nvm.MacGroup2.MacParams.ReceiveDelay1 + MacCtx.RxWindow1Config.WindowOffset;
     MacCtx.RxWindow2Delay = Nvm.MacGroup2.MacParams.ReceiveDelay2 + MacCtx.RxWindow2Config.WindowOffset;
@@ -2928,6 +3309,8 @@ static LoRaMacStatus_t ScheduleTx( bool allowDelayedTx )
     nextChan.LastTxIsJoinRequest = false;
     nextChan.Joined = true;
     nextChan.PktLen = MacCtx.PktBufferLen;
+    nextChan.PreambleLength = GetTxPreambleLength( );
+    nextChan.LbtCadEnabled = IsLbtCadActive( );
 
     // Setup the parameters based on the join status
     if( Nvm.MacGroup2.NetworkActivation == ACTIVATION_TYPE_NONE )
@@ -3113,6 +3496,7 @@ static void ResetMacParameters( void )
     MacCtx.RxWindow2Config.Frequency = Nvm.MacGroup2.MacParams.Rx2Channel.Frequency;
     MacCtx.RxWindow2Config.DownlinkDwellTime = Nvm.MacGroup2.MacParams.DownlinkDwellTime;
     MacCtx.RxWindow2Config.RxContinuous = false;
+    MacCtx.RxWindow2Config.PreambleLength = REGION_COMMON_DEFAULT_PREAMBLE_LENGTH;
     MacCtx.RxWindow2Config.RxSlot = RX_SLOT_WIN_2;
     MacCtx.RxWindow2Config.NetworkActivation = Nvm.MacGroup2.NetworkActivation;
 
@@ -3121,6 +3505,17 @@ static void ResetMacParameters( void )
     MacCtx.RxWindowCConfig.RxContinuous = true;
     MacCtx.RxWindowCConfig.RxSlot = RX_SLOT_WIN_CLASS_C;
 
+    // Initialize RxC sniff parameters.
+    MacCtx.RxCSniff.Enabled = false;
+    MacCtx.RxCSniff.PreambleLength = REGION_COMMON_DEFAULT_PREAMBLE_LENGTH;
+    MacCtx.RxCSniff.TxLongPreamble = false;
+
+    // Initialize listen before talk with CAD parameters.
+    MacCtx.LbtCad.Enabled = false;
+    MacCtx.LbtCad.CadSymbols = 2;
+    MacCtx.LbtCad.MaxAttempts = 4;
+    MacCtx.LbtCadAttempts = 0;
+
     // Initialize class b
     // Apply callback
     classBCallbacks.GetTemperatureLevel = NULL;
@@ -3168,6 +3563,18 @@ static void RxWindowSetup( TimerEvent_t* rxTimer, RxConfigParams_t* rxConfig )
 {
     TimerStop( rxTimer );
 
+    if( MacCtx.RxBufferHeld == true )
+    {
+        // The window is skipped. A frame received in RX1 or RX2 ends the
+        // cycle, otherwise a skipped RX2 window is reported as an RX2 error
+        if( ( rxConfig->RxSlot == RX_SLOT_WIN_2 ) &&
+            ( MacCtx.RxSlot != RX_SLOT_WIN_1 ) && ( MacCtx.RxSlot != RX_SLOT_WIN_2 ) )
+        {
+            OnRadioRxError( );
+        }
+        return;
+    }
+
     // Ensure the radio is Idle
     Radio.Standby( );
 
@@ -3180,6 +3587,12 @@ static void RxWindowSetup( TimerEvent_t* rxTimer, RxConfigParams_t* rxConfig )
 
 static void OpenContinuousRxCWindow( void )
 {
+    if( MacCtx.RxBufferHeld == true )
+    {
+        // Opened by LoRaMacProcess once the held frame has been released
+        return;
+    }
+
     // Compute RxC windows parameters
     RegionComputeRxWindowParameters( Nvm.MacGroup2.Region,
                                      Nvm.MacGroup2.MacParams.RxCChannel.Datarate,
@@ -3191,16 +3604,81 @@ static void OpenContinuousRxCWindow( void )
     MacCtx.RxWindowCConfig.NetworkActivation = Nvm.MacGroup2.NetworkActivation;
     // Setup continuous listening
     MacCtx.RxWindowCConfig.RxContinuous = true;
+    MacCtx.RxWindowCConfig.PreambleLength = REGION_COMMON_DEFAULT_PREAMBLE_LENGTH;
+    if( MacCtx.RxCSniff.Enabled == true )
+    {
+        MacCtx.RxWindowCConfig.PreambleLength = MacCtx.RxCSniff.PreambleLength;
+    }
 
     // At this point the Radio should be idle.
     // Thus, there is no need to set the radio in standby mode.
     if( RegionRxConfig( Nvm.MacGroup2.Region, &MacCtx.RxWindowCConfig, ( int8_t* )&MacCtx.McpsIndication.RxDatarate ) == true )
     {
-        Radio.Rx( 0 ); // Continuous mode
+        uint32_t rxTime = 0;
+        uint32_t sleepTime = 0;
+
+        if( ComputeRxCSniffWindows( &rxTime, &sleepTime ) == true )
+        {
+            Radio.SetRxDutyCycle( rxTime, sleepTime );
+        }
+        else
+        {
+            Radio.Rx( 0 ); // Continuous mode
+        }
         MacCtx.RxSlot = MacCtx.RxWindowCConfig.RxSlot;
     }
 }
 
+static bool ComputeRxCSniffWindows( uint32_t* rxTime, uint32_t* sleepTime )
+{
+    GetPhyParams_t getPhy;
+    PhyParam_t phyParam;
+    uint32_t spreadingFactor = 0;
+    uint32_t tSymbolInUs = 0;
+    uint32_t rxSymbols = Nvm.MacGroup2.MacParams.MinRxSymbols;
+    uint32_t rxTimeInUs = 0;
+    uint32_t sleepTimeInUs = 0;
+    uint32_t wakeUpTimeInUs = Radio.GetWakeupTime( ) * 1000;
+
+    if( ( MacCtx.RxCSniff.Enabled == false ) || ( Radio.SetRxDutyCycle == NULL ) )
+    {
+        return false;
+    }
+
+    getPhy.Attribute = PHY_SF_FROM_DR;
+    getPhy.Datarate = MacCtx.RxWindowCConfig.Datarate;
+    phyParam = RegionGetPhyParam( Nvm.MacGroup2.Region, &getPhy );
+    spreadingFactor = phyParam.Value;
+    if( ( spreadingFactor < 5 ) || ( spreadingFactor > 12 ) )
+    {
+        // FSK datarate
+        return false;
+    }
+
+    getPhy.Attribute = PHY_BW_FROM_DR;
+    phyParam = RegionGetPhyParam( Nvm.MacGroup2.Region, &getPhy );
+    tSymbolInUs = RegionCommonComputeSymbolTimeLoRa( spreadingFactor, 125000 << phyParam.Value );
+
+    // A preamble starting right after a listen window must still cover the
+    // sleep period plus one full listen window to be detected.
+    if( MacCtx.RxCSniff.PreambleLength <= ( 2 * rxSymbols ) )
+    {
+        return false;
+    }
+    rxTimeInUs = rxSymbols * tSymbolInUs;
+    sleepTimeInUs = ( MacCtx.RxCSniff.PreambleLength - ( 2 * rxSymbols ) ) * tSymbolInUs;
+    if( sleepTimeInUs <= wakeUpTimeInUs )
+    {
+        return false;
+    }
+    sleepTimeInUs -= wakeUpTimeInUs;
+
+    // Convert to 15.625 us steps, the radio timers are 24 bits wide
+    *rxTime = MIN( ( ( rxTimeInUs / 125 ) * 8 ) + ( ( ( rxTimeInUs % 125 ) * 8 ) / 125 ), 0xFFFFFF );
+    *sleepTime = MIN( ( ( sleepTimeInUs / 125 ) * 8 ) + ( ( ( sleepTimeInUs % 125 ) * 8 ) / 125 ), 0xFFFFFF );
+    return true;
+}
+
 LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl, uint8_t fPort, void* fBuffer, uint16_t fBufferSize )
 {
     MacCtx.PktBufferLen = 0;
@@ -3214,7 +3692,6 @@ LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl
         fBufferSize = 0;
     }
 
-    memcpy1( MacCtx.AppData, ( uint8_t* ) fBuffer, fBufferSize );
     MacCtx.AppDataSize = fBufferSize;
     MacCtx.PktBuffer[0] = macHdr->Value;
 
@@ -3232,7 +3709,7 @@ LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl
             MacCtx.TxMsg.Message.Data.FHDR.DevAddr = Nvm.MacGroup2.DevAddr;
             MacCtx.TxMsg.Message.Data.FHDR.FCtrl.Value = fCtrl->Value;
             MacCtx.TxMsg.Message.Data.FRMPayloadSize = MacCtx.AppDataSize;
-            MacCtx.TxMsg.Message.Data.FRMPayload = MacCtx.AppData;
+            MacCtx.TxMsg.Message.Data.FRMPayload = NULL;
 
             if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoGetFCntUp( &fCntUp ) )
             {
@@ -3274,27 +3751,46 @@ LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl
                     {
                         return LORAMAC_STATUS_MAC_COMMAD_ERROR;
                     }
+                    if( SetupFrmPayload( fBuffer, MacCtx.AppDataSize ) != LORAMAC_STATUS_OK )
+                    {
+                        return LORAMAC_STATUS_LENGTH_ERROR;
+                    }
                     return LORAMAC_STATUS_SKIPPED_APP_DATA;
                 }
                 // No application payload available therefore add all mac commands to the FRMPayload.
                 else
                 {
-                    if( LoRaMacCommandsSerializeCmds( availableSize, &macCmdsSize, MacCtx.MacCommandsBuffer ) != LORAMAC_COMMANDS_SUCCESS )
+                    // Serialize the MAC commands directly at the FRMPayload position.
+                    // FOptsLen is zero in this case.
+                    MacCtx.TxMsg.Message.Data.FRMPayload = MacCtx.PktBuffer + LORAMAC_FRAME_PAYLOAD_OVERHEAD_SIZE - LORAMAC_MIC_FIELD_SIZE;
+                    if( LoRaMacCommandsSerializeCmds( availableSize, &macCmdsSize, MacCtx.TxMsg.Message.Data.FRMPayload ) != LORAMAC_COMMANDS_SUCCESS )
                     {
                         return LORAMAC_STATUS_MAC_COMMAD_ERROR;
                     }
                     // Force FPort to be zero
                     MacCtx.TxMsg.Message.Data.FPort = 0;
 
-                    MacCtx.TxMsg.Message.Data.FRMPayload = MacCtx.MacCommandsBuffer;
                     MacCtx.TxMsg.Message.Data.FRMPayloadSize = macCmdsSize;
                 }
             }
 
+            if( MacCtx.TxMsg.Message.Data.FRMPayload == NULL )
+            {
+                // Application payload is copied only once, to its final position
+                if( SetupFrmPayload( fBuffer, MacCtx.AppDataSize ) != LORAMAC_STATUS_OK )
+                {
+                    return LORAMAC_STATUS_LENGTH_ERROR;
+                }
+            }
+
             break;
         case FRAME_TYPE_PROPRIETARY:
             if( ( fBuffer != NULL ) && ( MacCtx.AppDataSize > 0 ) )
             {
+                if( ( LORAMAC_MHDR_FIELD_SIZE + MacCtx.AppDataSize ) > LORAMAC_PHY_MAXPAYLOAD )
+                {
+                    return LORAMAC_STATUS_LENGTH_ERROR;
+                }
                 memcpy1( MacCtx.PktBuffer + LORAMAC_MHDR_FIELD_SIZE, ( uint8_t* ) fBuffer, MacCtx.AppDataSize );
                 MacCtx.PktBufferLen = LORAMAC_MHDR_FIELD_SIZE + MacCtx.AppDataSize;
             }
@@ -3306,6 +3802,26 @@ LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl
     return LORAMAC_STATUS_OK;
 }
 
+static LoRaMacStatus_t SetupFrmPayload( void* fBuffer, uint16_t fBufferSize )
+{
+    uint16_t frmPayloadOffset = LORAMAC_MHDR_FIELD_SIZE + LORAMAC_FHDR_DEV_ADDR_FIELD_SIZE +
+                                LORAMAC_FHDR_F_CTRL_FIELD_SIZE + LORAMAC_FHDR_F_CNT_FIELD_SIZE +
+                                MacCtx.TxMsg.Message.Data.FHDR.FCtrl.Bits.FOptsLen +
+                                LORAMAC_F_PORT_FIELD_SIZE;
+
+    if( ( frmPayloadOffset + fBufferSize + LORAMAC_MIC_FIELD_SIZE ) > LORAMAC_PHY_MAXPAYLOAD )
+    {
+        return LORAMAC_STATUS_LENGTH_ERROR;
+    }
+
+    MacCtx.TxMsg.Message.Data.FRMPayload = MacCtx.PktBuffer + frmPayloadOffset;
+    if( fBufferSize > 0 )
+    {
+        memcpy1( MacCtx.TxMsg.Message.Data.FRMPayload, ( uint8_t* ) fBuffer, fBufferSize );
+    }
+    return LORAMAC_STATUS_OK;
+}
+
 LoRaMacStatus_t SendFrameOnChannel( uint8_t channel )
 {
     LoRaMacStatus_t status = LORAMAC_STATUS_PARAMETER_INVALID;
@@ -3318,6 +3834,7 @@ LoRaMacStatus_t SendFrameOnChannel( uint8_t channel )
     txConfig.MaxEirp = Nvm.MacGroup2.MacParams.MaxEirp;
     txConfig.AntennaGain = Nvm.MacGroup2.MacParams.AntennaGain;
     txConfig.PktLen = MacCtx.PktBufferLen;
+    txConfig.PreambleLength = GetTxPreambleLength( );
 
     RegionTxConfig( Nvm.MacGroup2.Region, &txConfig, &txPower, &MacCtx.TxTimeOnAir );
 
@@ -3363,12 +3880,216 @@ LoRaMacStatus_t SendFrameOnChannel( uint8_t channel )
     MacCtx.McpsConfirm.NbTrans = MacCtx.ChannelsNbTransCounter;
     MacCtx.ResponseTimeoutStartTime = 0;
 
+    if( IsLbtCadActive( ) == true )
+    {
+        // The frame is sent once the channel is found free
+        MacCtx.LbtCadAttempts = 0;
+        StartLbtCad( );
+        return LORAMAC_STATUS_OK;
+    }
+
+    if( MacCtx.RxBufferHeld == true )
+    {
+        // The SX127x drivers send the long FSK frames through their
+        // reception buffer. Send once the held frame has been released
+        MacCtx.TxOnRxBufferRelease = true;
+        return LORAMAC_STATUS_OK;
+    }
+
     // Send now
     Radio.Send( MacCtx.PktBuffer, MacCtx.PktBufferLen );
 
     return LORAMAC_STATUS_OK;
 }
 
+static TimerTime_t GetRadioIrqTime( void )
+{
+    if( Radio.GetIrqTime != NULL )
+    {
+        return Radio.GetIrqTime( );
+    }
+    return TimerGetCurrentTime( );
+}
+
+static bool GetLoRaSymbolTime( int8_t datarate, uint32_t* tSymbolInUs )
+{
+    GetPhyParams_t getPhy;
+    PhyParam_t phyParam;
+    uint32_t spreadingFactor = 0;
+
+    getPhy.Attribute = PHY_SF_FROM_DR;
+    getPhy.Datarate = datarate;
+    phyParam = RegionGetPhyParam( Nvm.MacGroup2.Region, &getPhy );
+    spreadingFactor = phyParam.Value;
+    if( ( spreadingFactor < 5 ) || ( spreadingFactor > 12 ) )
+    {
+        // FSK datarate
+        return false;
+    }
+
+    getPhy.Attribute = PHY_BW_FROM_DR;
+    phyParam = RegionGetPhyParam( Nvm.MacGroup2.Region, &getPhy );
+    *tSymbolInUs = RegionCommonComputeSymbolTimeLoRa( spreadingFactor, 125000 << phyParam.Value );
+    return true;
+}
+
+static void UpdateRxTimingWakeUp( TimerTime_t rxTimeoutTime )
+{
+    RxConfigParams_t* rxConfig = &MacCtx.RxWindow1Config;
+    uint32_t rxWindowDelay = MacCtx.RxWindow1Delay;
+    uint32_t tSymbolInUs = 0;
+    int32_t maxWakeUpTime = ( int32_t )( Radio.GetWakeupTime( ) + Nvm.MacGroup2.MacParams.SystemMaxRxError );
+    int32_t sample = 0;
+    int32_t error = 0;
+
+    if( MacCtx.RxSlot == RX_SLOT_WIN_2 )
+    {
+        rxConfig = &MacCtx.RxWindow2Config;
+        rxWindowDelay = MacCtx.RxWindow2Delay;
+    }
+    if( ( rxConfig->RxContinuous == true ) || ( GetLoRaSymbolTime( rxConfig->Datarate, &tSymbolInUs ) == false ) )
+    {
+        return;
+    }
+
+    // The radio signals the timeout WindowTimeout symbols after the receiver
+    // started. The remaining time since the window timer expiry is the wake up time.
+    sample = ( int32_t )( rxTimeoutTime - MacCtx.TxDoneTime - rxWindowDelay ) -
+             ( int32_t )( ( rxConfig->WindowTimeout * tSymbolInUs + 500 ) / 1000 );
+    if( ( sample < -( int32_t )Nvm.MacGroup2.MacParams.SystemMaxRxError ) || ( sample > maxWakeUpTime ) )
+    {
+        // Not a symbol timeout, e.g. a preamble was detected
+        return;
+    }
+    sample = MAX( sample, 0 );
+
+    if( MacCtx.RxTimingStats.NbWakeUpSamples == 0 )
+    {
+        MacCtx.RxTimingWakeUpAvg = sample << 3;
+        MacCtx.RxTimingWakeUpDev = sample << 1;
+    }
+    else
+    {
+        error = sample - ( MacCtx.RxTimingWakeUpAvg >> 3 );
+        MacCtx.RxTimingWakeUpAvg += error;
+        if( error < 0 )
+        {
+            error = -error;
+        }
+        MacCtx.RxTimingWakeUpDev += error - ( MacCtx.RxTimingWakeUpDev >> 2 );
+    }
+    if( MacCtx.RxTimingStats.NbWakeUpSamples < UINT16_MAX )
+    {
+        MacCtx.RxTimingStats.NbWakeUpSamples++;
+    }
+
+    // Timing error of four mean deviations plus one timer tick
+    MacCtx.RxTimingStats.WakeUpTime = ( ( uint32_t )MacCtx.RxTimingWakeUpAvg + 7 ) >> 3;
+    MacCtx.RxTimingStats.RxError = MIN( ( uint32_t )MacCtx.RxTimingWakeUpDev + 1, Nvm.MacGroup2.MacParams.SystemMaxRxError );
+}
+
+static void UpdateRxTimingMargin( uint16_t size )
+{
+    RxConfigParams_t* rxConfig = &MacCtx.RxWindow1Config;
+    uint32_t rxWindowDelay = MacCtx.RxWindow1Delay;
+    uint32_t wakeUpTime = Radio.GetWakeupTime( );
+    uint32_t tSymbolInUs = 0;
+    GetPhyParams_t getPhy;
+    PhyParam_t phyParamSf;
+    PhyParam_t phyParamBw;
+    TimerTime_t timeOnAir = 0;
+    int32_t margin = 0;
+
+    if( ( MacCtx.RxSlot != RX_SLOT_WIN_1 ) && ( MacCtx.RxSlot != RX_SLOT_WIN_2 ) )
+    {
+        return;
+    }
+    if( MacCtx.RxSlot == RX_SLOT_WIN_2 )
+    {
+        rxConfig = &MacCtx.RxWindow2Config;
+        rxWindowDelay = MacCtx.RxWindow2Delay;
+    }
+    if( GetLoRaSymbolTime( rxConfig->Datarate, &tSymbolInUs ) == false )
+    {
+        return;
+    }
+    if( MacCtx.RxTimingStats.NbWakeUpSamples >= RX_TIMING_MIN_SAMPLES )
+    {
+        wakeUpTime = MacCtx.RxTimingStats.WakeUpTime;
+    }
+
+    getPhy.Datarate = rxConfig->Datarate;
+    getPhy.Attribute = PHY_SF_FROM_DR;
+    phyParamSf = RegionGetPhyParam( Nvm.MacGroup2.Region, &getPhy );
+    getPhy.Attribute = PHY_BW_FROM_DR;
+    phyParamBw = RegionGetPhyParam( Nvm.MacGroup2.Region, &getPhy );
+    timeOnAir = Radio.TimeOnAir( MODEM_LORA, phyParamBw.Value, phyParamSf.Value, 1, REGION_COMMON_DEFAULT_PREAMBLE_LENGTH, false, size, false );
+
+    // Start of the downlink minus the time at which the receiver was ready
+    margin = ( int32_t )( MacCtx.RxDoneTime - timeOnAir - MacCtx.TxDoneTime - rxWindowDelay - wakeUpTime );
+
+    if( MacCtx.RxTimingStats.NbMarginSamples == 0 )
+    {
+        MacCtx.RxTimingStats.MinMargin = margin;
+        MacCtx.RxTimingStats.MaxMargin = margin;
+    }
+    if( MacCtx.RxTimingStats.NbMarginSamples < UINT16_MAX )
+    {
+        MacCtx.RxTimingStats.NbMarginSamples++;
+    }
+    MacCtx.RxTimingStats.LastMargin = margin;
+    MacCtx.RxTimingStats.MinMargin = MIN( MacCtx.RxTimingStats.MinMargin, margin );
+    MacCtx.RxTimingStats.MaxMargin = MAX( MacCtx.RxTimingStats.MaxMargin, margin );
+}
+
+static uint16_t GetTxPreambleLength( void )
+{
+    // Long preamble so that a peer in sniff mode receives the uplink
+    if( MacCtx.RxCSniff.TxLongPreamble == true )
+    {
+        return MacCtx.RxCSniff.PreambleLength;
+    }
+    return REGION_COMMON_DEFAULT_PREAMBLE_LENGTH;
+}
+
+static bool IsLbtCadActive( void )
+{
+    GetPhyParams_t getPhy;
+    PhyParam_t phyParam;
+
+    if( ( MacCtx.LbtCad.Enabled == false ) || ( Radio.SetCadParams == NULL ) )
+    {
+        return false;
+    }
+
+    // CAD only detects LoRa signals, FSK uplinks keep the RSSI carrier sense
+    getPhy.Attribute = PHY_SF_FROM_DR;
+    getPhy.Datarate = Nvm.MacGroup1.ChannelsDatarate;
+    phyParam = RegionGetPhyParam( Nvm.MacGroup2.Region, &getPhy );
+    if( ( phyParam.Value < 5 ) || ( phyParam.Value > 12 ) )
+    {
+        return false;
+    }
+    return true;
+}
+
+static void StartLbtCad( void )
+{
+    if( MacCtx.RxSlot == RX_SLOT_WIN_CLASS_C )
+    {
+        // The CAD closes the RX C window, it is re-opened once the frame is sent
+        MacCtx.RxSlot = RX_SLOT_NONE;
+    }
+
+    MacCtx.LbtCadAttempts++;
+
+    // The radio is configured for the transmission, the CAD uses the same
+    // channel and LoRa modulation parameters
+    Radio.Standby( );
+    Radio.SetCadParams( MacCtx.LbtCad.CadSymbols );
+    Radio.StartCad( );
+}
+
 LoRaMacStatus_t SetTxContinuousWave( uint16_t timeout, uint32_t frequency, uint8_t power )
 {
     Radio.SetTxContinuousWave( frequency, power, timeout );
@@ -3429,6 +4150,8 @@ LoRaMacStatus_t RestoreNvmData( LoRaMacNvmData_t* nvm )
         MacCtx.RxWindowCConfig.DownlinkDwellTime = Nvm.MacGroup2.MacParams.DownlinkDwellTime;
         MacCtx.RxWindowCConfig.RxContinuous = true;
         MacCtx.RxWindowCConfig.RxSlot = RX_SLOT_WIN_CLASS_C;
+
+        McAddrLutBuild( );
     }
 
     // Secure Element
@@ -3786,6 +4509,12 @@ LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t* primitives, LoRaMacC
 
     // Initialize timers
     TimerInit( &MacCtx.TxDelayedTimer, OnTxDelayedTimerEvent );
+    TimerInit( &MacCtx.LbtCadTimer, OnLbtCadTimerEvent );
+
+    // Reset the reception windows timing statistics
+    memset1( ( uint8_t* )&MacCtx.RxTimingStats, 0, sizeof( RxTimingStats_t ) );
+    MacCtx.RxTimingWakeUpAvg = 0;
+    MacCtx.RxTimingWakeUpDev = 0;
     TimerInit( &MacCtx.RxWindowTimer1, OnRxWindow1TimerEvent );
     TimerInit( &MacCtx.RxWindowTimer2, OnRxWindow2TimerEvent );
     TimerInit( &MacCtx.RetransmitTimeoutTimer, OnRetransmitTimeoutTimerEvent );
@@ -3798,7 +4527,11 @@ LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t* primitives, LoRaMacC
     Nvm.MacGroup2.InitializationTime = SysTimeGetMcuTime( );
 
     // Initialize MAC radio events
-    LoRaMacRadioEvents.Value = 0;
+    RadioEventQueueInit( &LoRaMacRadioEvents );
+    MacCtx.RxDoneEventHeld = false;
+    MacCtx.RxBufferHeld = false;
+    MacCtx.TxOnRxBufferRelease = false;
+    MacCtx.RxCErrorEventPending = false;
 
     // Initialize Radio driver
     MacCtx.RadioEvents.TxDone = OnRadioTxDone;
@@ -3806,6 +4539,7 @@ LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t* primitives, LoRaMacC
     MacCtx.RadioEvents.RxError = OnRadioRxError;
     MacCtx.RadioEvents.TxTimeout = OnRadioTxTimeout;
     MacCtx.RadioEvents.RxTimeout = OnRadioRxTimeout;
+    MacCtx.RadioEvents.CadDone = OnRadioCadDone;
     Radio.Init( &MacCtx.RadioEvents );
 
     // Initialize the Secure Element driver
@@ -4119,6 +4853,21 @@ LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t* mibGet )
             mibGet->Param.IsCertPortOn = Nvm.MacGroup2.IsCertPortOn;
             break;
         }
+        case MIB_RXC_SNIFF:
+        {
+            mibGet->Param.RxCSniff = MacCtx.RxCSniff;
+            break;
+        }
+        case MIB_LBT_CAD:
+        {
+            mibGet->Param.LbtCad = MacCtx.LbtCad;
+            break;
+        }
+        case MIB_RX_TIMING_STATS:
+        {
+            mibGet->Param.RxTimingStats = MacCtx.RxTimingStats;
+            break;
+        }
         case MIB_REJOIN_0_CYCLE:
         {
             mibGet->Param.Rejoin0CycleInSec = Nvm.MacGroup2.Rejoin0CycleInSec;
@@ -4779,6 +5528,39 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
             Nvm.MacGroup2.IsCertPortOn = mibSet->Param.IsCertPortOn;
             break;
         }
+        case MIB_RXC_SNIFF:
+        {
+            if( mibSet->Param.RxCSniff.PreambleLength >= REGION_COMMON_DEFAULT_PREAMBLE_LENGTH )
+            {
+                MacCtx.RxCSniff = mibSet->Param.RxCSniff;
+
+                if( ( Nvm.MacGroup2.DeviceClass == CLASS_C ) && ( Nvm.MacGroup2.NetworkActivation != ACTIVATION_TYPE_NONE ) )
+                {
+                    // Restart the RX C window with the new settings
+                    Radio.Sleep( );
+
+                    OpenContinuousRxCWindow( );
+                }
+            }
+            else
+            {
+                status = LORAMAC_STATUS_PARAMETER_INVALID;
+            }
+            break;
+        }
+        case MIB_LBT_CAD:
+        {
+            if( ( mibSet->Param.LbtCad.CadSymbols >= 1 ) && ( mibSet->Param.LbtCad.CadSymbols <= 16 ) &&
+                ( mibSet->Param.LbtCad.MaxAttempts >= 1 ) )
+            {
+                MacCtx.LbtCad = mibSet->Param.LbtCad;
+            }
+            else
+            {
+                status = LORAMAC_STATUS_PARAMETER_INVALID;
+            }
+            break;
+        }
         case MIB_REJOIN_0_CYCLE:
         {
             if( ConvertRejoinCycleTime( Nvm.MacGroup2.Rejoin0CycleInSec, &MacCtx.Rejoin0CycleTime ) == true )
@@ -4872,11 +5654,11 @@ LoRaMacStatus_t LoRaMacMcChannelSetup( McChannelParams_t *channel )
     }
 
     Nvm.MacGroup2.MulticastChannelList[channel->GroupID].ChannelParams = *channel;
+    McAddrLutBuild( );
 
     if( channel->IsRemotelySetup == true )
     {
-        const KeyIdentifier_t mcKeys[LORAMAC_MAX_MC_CTX] = { MC_KEY_0, MC_KEY_1, MC_KEY_2, MC_KEY_3 };
-        if( LoRaMacCryptoSetKey( mcKeys[channel->GroupID], channel->McKeys.McKeyE ) != LORAMAC_CRYPTO_SUCCESS )
+        if( LoRaMacCryptoSetKey( LORAMAC_MC_KEY_ID( channel->GroupID ), channel->McKeys.McKeyE ) != LORAMAC_CRYPTO_SUCCESS )
         {
             return LORAMAC_STATUS_CRYPTO_ERROR;
         }
@@ -4888,13 +5670,11 @@ LoRaMacStatus_t LoRaMacMcChannelSetup( McChannelParams_t *channel )
     }
     else
     {
-        const KeyIdentifier_t mcAppSKeys[LORAMAC_MAX_MC_CTX] = { MC_APP_S_KEY_0, MC_APP_S_KEY_1, MC_APP_S_KEY_2, MC_APP_S_KEY_3 };
-        const KeyIdentifier_t mcNwkSKeys[LORAMAC_MAX_MC_CTX] = { MC_NWK_S_KEY_0, MC_NWK_S_KEY_1, MC_NWK_S_KEY_2, MC_NWK_S_KEY_3 };
-        if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( mcAppSKeys[channel->GroupID], channel->McKeys.Session.McAppSKey ) )
+        if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( LORAMAC_MC_APP_S_KEY_ID( channel->GroupID ), channel->McKeys.Session.McAppSKey ) )
         {
             return LORAMAC_STATUS_CRYPTO_ERROR;
         }
-        if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( mcNwkSKeys[channel->GroupID], channel->McKeys.Session.McNwkSKey ) )
+        if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( LORAMAC_MC_NWK_S_KEY_ID( channel->GroupID ), channel->McKeys.Session.McNwkSKey ) )
         {
             return LORAMAC_STATUS_CRYPTO_ERROR;
         }
@@ -4930,19 +5710,20 @@ LoRaMacStatus_t LoRaMacMcChannelDelete( AddressIdentifier_t groupID )
     memset1( ( uint8_t* )&channel, 0, sizeof( McChannelParams_t ) );
 
     Nvm.MacGroup2.MulticastChannelList[groupID].ChannelParams = channel;
+
+    McAddrLutBuild( );
     return LORAMAC_STATUS_OK;
 }
 
 uint8_t LoRaMacMcChannelGetGroupId( uint32_t mcAddress )
 {
-    for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+    MulticastCtx_t* mcCtx = McAddrLutFind( mcAddress );
+
+    if( mcCtx == NULL )
     {
-        if( mcAddress == Nvm.MacGroup2.MulticastChannelList[i].ChannelParams.Address )
-        {
-            return i;
-        }
+        return 0xFF;
     }
-    return 0xFF;
+    return ( uint8_t )( mcCtx - Nvm.MacGroup2.MulticastChannelList );
 }
 
 LoRaMacStatus_t LoRaMacMcChannelSetupRxParams( AddressIdentifier_t groupID, McRxParams_t *rxParams, uint8_t *status )
@@ -5419,6 +6200,7 @@ LoRaMacStatus_t LoRaMacDeInitialization( void )
     {
         // Stop Timers
         TimerStop( &MacCtx.TxDelayedTimer );
+        TimerStop( &MacCtx.LbtCadTimer );
         TimerStop( &MacCtx.RxWindowTimer1 );
         TimerStop( &MacCtx.RxWindowTimer2 );
 
@@ -199,6 +199,97 @@ typedef struct sRxChannelParams
     uint8_t  Datarate;
 }RxChannelParams_t;
 
+/*!
+ * LoRaMAC continuous reception window sniff parameters
+ *
+ * In sniff mode the radio listens for MinRxSymbols symbols, then sleeps
+ * for as long as a preamble of PreambleLength symbols still overlaps the
+ * next listen window. The MAC keeps continuous reception when the preamble
+ * is too short for the radio to sleep between two listen windows.
+ */
+typedef struct sRxCSniffParams
+{
+    /*!
+     * Set to true to duty cycle the radio during the Class C continuous
+     * reception window
+     */
+    bool Enabled;
+    /*!
+     * Preamble length [symbols] of the frames received in the Class C
+     * window. The network must transmit with the same preamble length.
+     */
+    uint16_t PreambleLength;
+    /*!
+     * Set to true to transmit the uplinks with a PreambleLength symbols
+     * preamble, so that they can be received by a peer in sniff mode
+     */
+    bool TxLongPreamble;
+}RxCSniffParams_t;
+
+/*!
+ * LoRaMAC listen before talk with channel activity detection parameters
+ *
+ * When enabled, LoRa uplinks are preceded by an interrupt driven CAD on the
+ * selected channel, which replaces the RSSI carrier sense of the regions
+ * requiring listen before talk. FSK uplinks keep the RSSI carrier sense.
+ */
+typedef struct sLbtCadParams
+{
+    /*!
+     * Set to true to perform the listen before talk with CAD
+     */
+    bool Enabled;
+    /*!
+     * CAD duration [symbols]. Supported values are 1, 2, 4, 8 and 16.
+     */
+    uint8_t CadSymbols;
+    /*!
+     * Number of CAD attempts before the uplink is given up. A random back-off
+     * of up to the frame time on air is applied between two attempts.
+     */
+    uint8_t MaxAttempts;
+}LbtCadParams_t;
+
+/*!
+ * LoRaMAC reception windows timing statistics
+ *
+ * The Rx1 and Rx2 windows timeouts measure the actual board plus radio wake
+ * up time. Once enough of them have been collected, the learned wake up time
+ * and timing error replace the Radio.GetWakeupTime and SystemMaxRxError
+ * values used to compute the windows.
+ */
+typedef struct sRxTimingStats
+{
+    /*!
+     * Number of reception windows timeouts used to learn the wake up time
+     */
+    uint16_t NbWakeUpSamples;
+    /*!
+     * Learned board plus radio wake up time [ms]
+     */
+    uint32_t WakeUpTime;
+    /*!
+     * Learned timing error [ms], bounded by SystemMaxRxError
+     */
+    uint32_t RxError;
+    /*!
+     * Number of downlinks used for the margin statistics
+     */
+    uint16_t NbMarginSamples;
+    /*!
+     * Time between the receiver start and the start of the last downlink [ms]
+     */
+    int32_t LastMargin;
+    /*!
+     * Minimum margin observed [ms]
+     */
+    int32_t MinMargin;
+    /*!
+     * Maximum margin observed [ms]
+     */
+    int32_t MaxMargin;
+}RxTimingStats_t;
+
 /*!
  * LoRaMAC receive window enumeration
  */
@@ -460,6 +551,10 @@ typedef enum eLoRaMacEventInfoStatus
      * ToDo
      */
     LORAMAC_EVENT_INFO_STATUS_BEACON_NOT_FOUND,
+    /*!
+     * The channel was busy during all the listen before talk attempts
+     */
+    LORAMAC_EVENT_INFO_STATUS_CHANNEL_BUSY,
 }LoRaMacEventInfoStatus_t;
 
 /*!
@@ -1010,6 +1105,10 @@ typedef struct sMcpsIndication
     uint8_t FramePending;
     /*!
      * Pointer to the received data stream
+     *
+     * \remark Points into the radio receive buffer. The data is only valid
+     *         during the execution of the \ref LoRaMacPrimitives_t::MacMcpsIndication
+     *         callback and must be copied by the application if it is needed later.
      */
     uint8_t* Buffer;
     /*!
@@ -1401,6 +1500,9 @@ typedef struct sMlmeIndication
  * \ref MIB_RX2_DFAULT_CHANNEL                   | YES | YES
  * \ref MIB_RXC_CHANNEL                          | YES | YES
  * \ref MIB_RXC_DFAULT_CHANNEL                   | YES | YES
+ * \ref MIB_RXC_SNIFF                            | YES | YES
+ * \ref MIB_LBT_CAD                              | YES | YES
+ * \ref MIB_RX_TIMING_STATS                      | YES | NO
  * \ref MIB_CHANNELS_MASK                        | YES | YES
  * \ref MIB_CHANNELS_DEFAULT_MASK                | YES | YES
  * \ref MIB_CHANNELS_NB_TRANS                    | YES | YES
@@ -1869,6 +1971,18 @@ typedef enum eMib
       * LoRaWAN certification FPort handling state (ON/OFF)
       */
      MIB_IS_CERT_FPORT_ON,
+    /*!
+     * Radio duty cycling during the Class C continuous reception window
+     */
+    MIB_RXC_SNIFF,
+    /*!
+     * Listen before talk with channel activity detection
+     */
+    MIB_LBT_CAD,
+    /*!
+     * Reception windows timing statistics
+     */
+    MIB_RX_TIMING_STATS,
 }Mib_t;
 
 /*!
@@ -2315,6 +2429,24 @@ typedef union uMibParam
      * Related MIB type: \ref MIB_IS_CERT_FPORT_ON
      */
     bool IsCertPortOn;
+    /*!
+     * Class C continuous reception window sniff parameters
+     *
+     * Related MIB type: \ref MIB_RXC_SNIFF
+     */
+    RxCSniffParams_t RxCSniff;
+    /*!
+     * Listen before talk with channel activity detection parameters
+     *
+     * Related MIB type: \ref MIB_LBT_CAD
+     */
+    LbtCadParams_t LbtCad;
+    /*!
+     * Reception windows timing statistics
+     *
+     * Related MIB type: \ref MIB_RX_TIMING_STATS
+     */
+    RxTimingStats_t RxTimingStats;
 }MibParam_t;
 
 /*!
@@ -2587,6 +2719,20 @@ LoRaMacStatus_t LoRaMacStop( void );
  */
 bool LoRaMacIsBusy( void );
 
+/*!
+ * \brief Returns a value indicating if \ref LoRaMacProcess has work to do.
+ *
+ * \details Pending work consists of radio and Class B events, MAC state
+ *          machine events, pending indications, NVM handling and a Class C
+ *          continuous reception window which has to be re-opened.
+ *          The application may use this function to decide if the MCU is
+ *          allowed to enter a low power mode.
+ *
+ * \retval hasPendingWork [true: LoRaMacProcess must be called,
+ *                         false: MCU may enter low power mode]
+ */
+bool LoRaMacHasPendingWork( void );
+
 /*!
  * Processes the LoRaMac events.
  *
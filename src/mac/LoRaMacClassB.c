@@ -31,6 +31,93 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 
 #ifdef LORAMAC_CLASSB_ENABLED
 
+/*!
+ * Number of addresses hold by the ping offset cache. Index 0 is the unicast
+ * address, the following indexes are the multicast channels.
+ */
+#define PING_OFFSET_CACHE_NB_ITEMS                  ( 1 + LORAMAC_MAX_MC_CTX )
+
+/*!
+ * Maximum number of AES blocks encrypted at once by the ping offset cache
+ * update. Bounds its stack usage
+ */
+#define PING_OFFSET_CACHE_CHUNK_NB_BLOCKS           4
+
+/*!
+ * Ping offset cache. Holds the pseudo random values of all active addresses
+ * for the current beacon period.
+ */
+typedef struct sPingOffsetCache
+{
+    /*!
+     * Beacon time, GPS time in seconds modulo 2^32, of the cached values
+     */
+    uint32_t BeaconTime;
+    /*!
+     * Address of each item
+     */
+    uint32_t Address[PING_OFFSET_CACHE_NB_ITEMS];
+    /*!
+     * Pseudo random value of each item. The ping offset is
+     * Rand % PingPeriod
+     */
+    uint16_t Rand[PING_OFFSET_CACHE_NB_ITEMS];
+    /*!
+     * Set if the item holds a valid value
+     */
+    bool IsValid[PING_OFFSET_CACHE_NB_ITEMS];
+}PingOffsetCache_t;
+
+/*!
+ * Source of ping slots. Either the unicast address or a multicast channel
+ */
+typedef struct sPingSlotSource
+{
+    /*!
+     * Multicast channel, NULL for the unicast address
+     */
+    MulticastCtx_t *MulticastChannel;
+    /*!
+     * Address of the source
+     */
+    uint32_t Address;
+    /*!
+     * Ping offset of the current beacon period
+     */
+    uint16_t PingOffset;
+    /*!
+     * Ping period
+     */
+    uint16_t PingPeriod;
+    /*!
+     * Number of ping slots per beacon period
+     */
+    uint16_t PingNb;
+    /*!
+     * Datarate of the ping slots
+     */
+    int8_t Datarate;
+}PingSlotSource_t;
+
+/*!
+ * Ping slot timeline. Merges the slots of the unicast address and of all
+ * multicast channels of a beacon period, only the next slot is armed.
+ */
+typedef struct sPingSlotTimeline
+{
+    /*!
+     * Slot sources of the beacon period
+     */
+    PingSlotSource_t Sources[PING_OFFSET_CACHE_NB_ITEMS];
+    /*!
+     * Number of slot sources
+     */
+    uint8_t NbSources;
+    /*!
+     * Index of the source of the next slot
+     */
+    uint8_t NextSource;
+}PingSlotTimeline_t;
 
 /*
  * LoRaMac Class B Context structure
@@ -46,30 +133,30 @@ typedef struct sLoRaMacClassBCtx
     */
     BeaconContext_t BeaconCtx;
     /*!
+    * Ping offsets of the current beacon period
+    */
+    PingOffsetCache_t PingOffsetCache;
+    /*!
     * State of the beaconing mechanism
     */
     BeaconState_t BeaconState;
     /*!
-    * State of the ping slot mechanism
+    * Unicast and multicast slot sources of the current beacon period
     */
-    PingSlotState_t PingSlotState;
+    PingSlotTimeline_t PingSlotTimeline;
     /*!
-    * State of the multicast slot mechanism
+    * State of the ping slot mechanism
     */
-    PingSlotState_t MulticastSlotState;
+    PingSlotState_t PingSlotState;
     /*!
     * Timer for CLASS B beacon acquisition and tracking.
     */
     TimerEvent_t BeaconTimer;
     /*!
-    * Timer for CLASS B ping slot timer.
+    * Timer for CLASS B unicast and multicast ping slots.
     */
     TimerEvent_t PingSlotTimer;
     /*!
-    * Timer for CLASS B multicast ping slot timer.
-    */
-    TimerEvent_t MulticastSlotTimer;
-    /*!
     * Container for the callbacks related to class b.
     */
     LoRaMacClassBCallback_t LoRaMacClassBCallbacks;
@@ -90,7 +177,6 @@ typedef union uLoRaMacClassBEvents
     {
         uint32_t Beacon        : 1;
         uint32_t PingSlot      : 1;
-        uint32_t MulticastSlot : 1;
     }Events;
 }LoRaMacClassBEvents_t;
 
@@ -116,41 +202,240 @@ static const uint8_t BeaconPrecTimeValue[4] = { 0, 1, 1, 1 };
 static LoRaMacClassBNvmData_t* ClassBNvm;
 
 /*!
- * Computes the Ping Offset
+ * Gets the address of a ping offset cache item
+ *
+ * \param [IN]  index           - Cache index. 0 for the unicast address,
+ *                                 1 + GroupID for multicast channels
+ * \param [OUT] address         - Address of the item. 0 if not active
+ *
+ * \retval True if the item is active and needs a ping offset
+ */
+static bool GetPingOffsetCacheAddress( uint8_t index, uint32_t* address )
+{
+    MulticastCtx_t *cur = Ctx.LoRaMacClassBParams.MulticastChannels;
+
+    if( index == 0 )
+    {
+        *address = *Ctx.LoRaMacClassBParams.LoRaMacDevAddr;
+        return true;
+    }
+    *address = 0;
+    if( ( cur != NULL ) && ( cur[index - 1].ChannelParams.IsEnabled == true ) && ( cur[index - 1].PingPeriod != 0 ) )
+    {
+        *address = cur[index - 1].ChannelParams.Address;
+        return true;
+    }
+    return false;
+}
+
+/*!
+ * Updates the ping offset cache when the beacon time or one of the addresses
+ * changed. The pseudo random values of the active addresses are computed by
+ * chunks of PING_OFFSET_CACHE_CHUNK_NB_BLOCKS AES blocks, so that the stack
+ * usage does not depend on the number of multicast channels.
  *
  * \param [IN]  beaconTime      - Time of the recent received beacon
- * \param [IN]  address         - Frame address
- * \param [IN]  pingPeriod      - Ping period of the node
- * \param [OUT] pingOffset      - Pseudo random ping offset
  */
-static void ComputePingOffset( uint64_t beaconTime, uint32_t address, uint16_t pingPeriod, uint16_t *pingOffset )
+static void UpdatePingOffsetCache( uint64_t beaconTime )
 {
-    uint8_t buffer[16];
-    uint8_t cipher[16];
-    uint32_t result = 0;
+    uint8_t buffer[PING_OFFSET_CACHE_CHUNK_NB_BLOCKS * 16];
+    uint8_t cipher[PING_OFFSET_CACHE_CHUNK_NB_BLOCKS * 16];
+    uint8_t indexes[PING_OFFSET_CACHE_CHUNK_NB_BLOCKS];
+    uint8_t nbBlocks = 0;
+    uint32_t address;
+    bool isActive;
     /* Refer to chapter 15.2 of the LoRaWAN specification v1.1. The beacon time
      * GPS time in seconds modulo 2^32
      */
     uint32_t time = ( beaconTime % ( ( ( uint64_t ) 1 ) << 32 ) );
+    bool isUpToDate = ( Ctx.PingOffsetCache.BeaconTime == time );
 
-    memset1( buffer, 0, 16 );
-    memset1( cipher, 0, 16 );
+    for( uint8_t i = 0; ( i < PING_OFFSET_CACHE_NB_ITEMS ) && ( isUpToDate == true ); i++ )
+    {
+        isActive = GetPingOffsetCacheAddress( i, &address );
+        if( ( isActive == true ) &&
+            ( ( Ctx.PingOffsetCache.IsValid[i] == false ) || ( Ctx.PingOffsetCache.Address[i] != address ) ) )
+        {
+            isUpToDate = false;
+        }
+    }
+    if( isUpToDate == true )
+    {
+        return;
+    }
 
-    buffer[0] = ( time ) & 0xFF;
-    buffer[1] = ( time >> 8 ) & 0xFF;
-    buffer[2] = ( time >> 16 ) & 0xFF;
-    buffer[3] = ( time >> 24 ) & 0xFF;
+    // Bytes 8 to 15 of the blocks remain zero
+    memset1( buffer, 0, sizeof( buffer ) );
 
-    buffer[4] = ( address ) & 0xFF;
-    buffer[5] = ( address >> 8 ) & 0xFF;
-    buffer[6] = ( address >> 16 ) & 0xFF;
-    buffer[7] = ( address >> 24 ) & 0xFF;
+    for( uint8_t i = 0; i < PING_OFFSET_CACHE_NB_ITEMS; i++ )
+    {
+        isActive = GetPingOffsetCacheAddress( i, &address );
+        Ctx.PingOffsetCache.Address[i] = address;
+        Ctx.PingOffsetCache.IsValid[i] = isActive;
+        Ctx.PingOffsetCache.Rand[i] = 0;
+        if( isActive == true )
+        {
+            uint8_t *block = &buffer[nbBlocks * 16];
+
+            block[0] = ( time ) & 0xFF;
+            block[1] = ( time >> 8 ) & 0xFF;
+            block[2] = ( time >> 16 ) & 0xFF;
+            block[3] = ( time >> 24 ) & 0xFF;
+
+            block[4] = ( address ) & 0xFF;
+            block[5] = ( address >> 8 ) & 0xFF;
+            block[6] = ( address >> 16 ) & 0xFF;
+            block[7] = ( address >> 24 ) & 0xFF;
+            indexes[nbBlocks++] = i;
+        }
 
-    SecureElementAesEncrypt( buffer, 16, SLOT_RAND_ZERO_KEY, cipher );
+        if( ( nbBlocks == PING_OFFSET_CACHE_CHUNK_NB_BLOCKS ) ||
+            ( ( i == ( PING_OFFSET_CACHE_NB_ITEMS - 1 ) ) && ( nbBlocks > 0 ) ) )
+        {
+            SecureElementAesEncrypt( buffer, nbBlocks * 16, SLOT_RAND_ZERO_KEY, cipher );
 
-    result = ( ( ( uint32_t ) cipher[0] ) + ( ( ( uint32_t ) cipher[1] ) * 256 ) );
+            for( uint8_t j = 0; j < nbBlocks; j++ )
+            {
+                Ctx.PingOffsetCache.Rand[indexes[j]] = ( uint16_t )( ( ( uint32_t ) cipher[j * 16] ) +
+                                                                     ( ( ( uint32_t ) cipher[( j * 16 ) + 1] ) * 256 ) );
+            }
+            nbBlocks = 0;
+        }
+    }
+    Ctx.PingOffsetCache.BeaconTime = time;
+}
 
-    *pingOffset = ( uint16_t )( result % pingPeriod );
+/*!
+ * Gets the Ping Offset from the ping offset cache
+ *
+ * \param [IN]  index           - Cache index. 0 for the unicast address,
+ *                                 1 + GroupID for multicast channels
+ * \param [IN]  pingPeriod      - Ping period of the address
+ *
+ * \retval Pseudo random ping offset
+ */
+static uint16_t GetPingOffset( uint8_t index, uint16_t pingPeriod )
+{
+    if( ( pingPeriod == 0 ) || ( Ctx.PingOffsetCache.IsValid[index] == false ) )
+    {
+        return 0;
+    }
+    return ( uint16_t )( Ctx.PingOffsetCache.Rand[index] % pingPeriod );
+}
+
+/*!
+ * \brief Verifies if the beacon drift estimator has enough samples to
+ *        be used
+ *
+ * \retval [true: drift estimated, false: not enough samples]
+ */
+static bool IsDriftEstimated( void )
+{
+    return ( Ctx.BeaconCtx.Drift.NbSamples >= CLASSB_DRIFT_MIN_NB_SAMPLES );
+}
+
+/*!
+ * \brief Updates the beacon drift estimator. The local time elapsed between
+ *        two beacon receptions is compared to the beacon intervals,
+ *        corrected by the temperature compensation.
+ *
+ * \param [IN] rxDoneTime Timer time of the beacon RxDone event
+ */
+static void UpdateBeaconDrift( TimerTime_t rxDoneTime )
+{
+    BeaconDrift_t *drift = &Ctx.BeaconCtx.Drift;
+    TimerTime_t elapsed = rxDoneTime - drift->LastRxDone;
+    uint32_t nbIntervals = ( elapsed + ( CLASSB_BEACON_INTERVAL / 2 ) ) / CLASSB_BEACON_INTERVAL;
+
+    if( ( drift->LastRxDone != 0 ) && ( nbIntervals > 0 ) && ( elapsed <= CLASSB_MAX_BEACON_LESS_PERIOD ) )
+    {
+        TimerTime_t nominal = nbIntervals * CLASSB_BEACON_INTERVAL;
+        TimerTime_t expected = TimerTempCompensation( nominal, Ctx.BeaconCtx.Temperature );
+        float sample = ( ( float )( ( int32_t )( elapsed - expected ) ) * 1000000.0f ) / ( float )nominal;
+
+        if( drift->NbSamples == 0 )
+        {
+            // The first sample is only known to the timing error
+            drift->Ppm = sample;
+            drift->DevPpm = ( ( float )CLASSB_DRIFT_TIMING_ERROR * 1000000.0f ) / ( float )nominal;
+        }
+        else
+        {
+            float residual = sample - drift->Ppm;
+
+            drift->Ppm += residual / CLASSB_DRIFT_FILTER_FACTOR;
+            drift->DevPpm += ( fabsf( residual ) - drift->DevPpm ) / CLASSB_DRIFT_FILTER_FACTOR;
+        }
+        if( drift->NbSamples < UINT8_MAX )
+        {
+            drift->NbSamples++;
+        }
+    }
+    drift->LastRxDone = rxDoneTime;
+}
+
+/*!
+ * \brief Compensates a period with the temperature compensation and the
+ *        estimated beacon drift
+ *
+ * \param [IN] period Period to compensate
+ *
+ * \retval Compensated period
+ */
+static TimerTime_t BeaconDriftCompensation( TimerTime_t period )
+{
+    TimerTime_t compensated = TimerTempCompensation( period, Ctx.BeaconCtx.Temperature );
+
+    if( IsDriftEstimated( ) == true )
+    {
+        int32_t correction = ( int32_t )( ( ( float )period * Ctx.BeaconCtx.Drift.Ppm ) / 1000000.0f );
+
+        if( ( correction > 0 ) || ( ( TimerTime_t )( -correction ) < compensated ) )
+        {
+            compensated += correction;
+        }
+    }
+    return compensated;
+}
+
+/*!
+ * \brief Calculates the maximum rx error of a reception window. When the
+ *        beacon drift is estimated, the error is derived from the drift
+ *        uncertainty accumulated since the last beacon. It never exceeds
+ *        the system maximum rx error.
+ *
+ * \param [IN] windowTime Timer time of the reception window
+ *
+ * \retval Maximum rx error in ms
+ */
+static uint32_t CalcMaxRxError( TimerTime_t windowTime )
+{
+    uint32_t maxRxError = Ctx.LoRaMacClassBParams.LoRaMacParams->SystemMaxRxError;
+
+    if( ( IsDriftEstimated( ) == true ) && ( windowTime > Ctx.BeaconCtx.Drift.LastRxDone ) )
+    {
+        float devPpm = MAX( Ctx.BeaconCtx.Drift.DevPpm * CLASSB_DRIFT_DEV_FACTOR, CLASSB_DRIFT_MIN_DEV_PPM );
+        float elapsed = ( float )( windowTime - Ctx.BeaconCtx.Drift.LastRxDone );
+        uint32_t driftRxError = CLASSB_DRIFT_TIMING_ERROR + ( uint32_t )ceilf( ( elapsed * devPpm ) / 1000000.0f );
+
+        maxRxError = MIN( maxRxError, driftRxError );
+    }
+
+    // Compare and assign the maximum between the rx error window time
+    // and time precision received from beacon frame format.
+    return MAX( maxRxError, ( uint32_t ) Ctx.BeaconCtx.BeaconTimePrecision.SubSeconds );
+}
+
+/*!
+ * \brief Calculates the timer time of the next expected beacon RxDone
+ *
+ * \retval Timer time of the next beacon
+ */
+static TimerTime_t CalcNextBeaconRxDone( void )
+{
+    TimerTime_t elapsed = TimerGetCurrentTime( ) - Ctx.BeaconCtx.Drift.LastRxDone;
+
+    return Ctx.BeaconCtx.Drift.LastRxDone + ( ( ( elapsed / CLASSB_BEACON_INTERVAL ) + 1 ) * CLASSB_BEACON_INTERVAL );
 }
 
 /*!
@@ -262,10 +547,8 @@ static void CalculateBeaconRxWindowConfig( RxConfigParams_t* rxConfig, uint16_t
         getPhy.Attribute = PHY_BEACON_CHANNEL_DR;
         phyParam = RegionGetPhyParam( *Ctx.LoRaMacClassBParams.LoRaMacRegion, &getPhy );
 
-        // Compare and assign the maximum between the region specific rx error window time
-        // and time precision received from beacon frame format.
-        maxRxError = MAX( Ctx.LoRaMacClassBParams.LoRaMacParams->SystemMaxRxError,
-                          ( uint32_t ) Ctx.BeaconCtx.BeaconTimePrecision.SubSeconds );
+        // Get the rx error of the next beacon window
+        maxRxError = CalcMaxRxError( CalcNextBeaconRxDone( ) );
 
         // Calculate downlink symbols
         RegionComputeRxWindowParameters( *Ctx.LoRaMacClassBParams.LoRaMacRegion,
@@ -326,52 +609,6 @@ static void RxBeaconSetup( TimerTime_t rxTime, bool activateDefaultChannel, uint
     Ctx.LoRaMacClassBParams.MlmeIndication->BeaconInfo.Datarate = Ctx.LoRaMacClassBParams.McpsIndication->RxDatarate;
 }
 
-/*!
- * \brief Calculates the next ping slot time.
- *
- * \param [IN] slotOffset The ping slot offset
- * \param [IN] pingPeriod The ping period
- * \param [OUT] timeOffset Time offset of the next slot, based on current time
- *
- * \retval [true: ping slot found, false: no ping slot found]
- */
-static bool CalcNextSlotTime( uint16_t slotOffset, uint16_t pingPeriod, uint16_t pingNb, TimerTime_t* timeOffset )
-{
-    uint8_t currentPingSlot = 0;
-    TimerTime_t slotTime = 0;
-    TimerTime_t currentTime = TimerGetCurrentTime( );
-
-    // Calculate the point in time of the last beacon even if we missed it
-    slotTime = ( ( currentTime - SysTimeToMs( Ctx.BeaconCtx.LastBeaconRx ) ) % CLASSB_BEACON_INTERVAL );
-    slotTime = currentTime - slotTime;
-
-    // Add the reserved time and the ping offset
-    slotTime += CLASSB_BEACON_RESERVED;
-    slotTime += slotOffset * CLASSB_PING_SLOT_WINDOW;
-
-    if( slotTime < currentTime )
-    {
-        currentPingSlot = ( ( currentTime - slotTime ) /
-                          ( pingPeriod * CLASSB_PING_SLOT_WINDOW ) ) + 1;
-        slotTime += ( ( TimerTime_t )( currentPingSlot * pingPeriod ) *
-                    CLASSB_PING_SLOT_WINDOW );
-    }
-
-    if( currentPingSlot < pingNb )
-    {
-        if( slotTime <= ( SysTimeToMs( Ctx.BeaconCtx.NextBeaconRx ) - CLASSB_BEACON_GUARD - CLASSB_PING_SLOT_WINDOW ) )
-        {
-            // Calculate the relative ping slot time
-            slotTime -= currentTime;
-            slotTime -= Radio.GetWakeupTime( );
-            slotTime = TimerTempCompensation( slotTime, Ctx.BeaconCtx.Temperature );
-            *timeOffset = slotTime;
-            return true;
-        }
-    }
-    return false;
-}
-
 /*!
  * \brief Calculates CRC's of the beacon frame
  *
@@ -425,6 +662,7 @@ static void InitClassB( void )
     memset1( ( uint8_t* ) ClassBNvm, 0, sizeof( LoRaMacClassBNvmData_t ) );
     memset1( ( uint8_t* ) &Ctx.PingSlotCtx, 0, sizeof( PingSlotContext_t ) );
     memset1( ( uint8_t* ) &Ctx.BeaconCtx, 0, sizeof( BeaconContext_t ) );
+    memset1( ( uint8_t* ) &Ctx.PingOffsetCache, 0, sizeof( PingOffsetCache_t ) );
 
     // Setup default temperature
     Ctx.BeaconCtx.Temperature = 25.0;
@@ -441,7 +679,6 @@ static void InitClassB( void )
     // Setup default states
     Ctx.BeaconState = BEACON_STATE_ACQUISITION;
     Ctx.PingSlotState = PINGSLOT_STATE_CALC_PING_OFFSET;
-    Ctx.MulticastSlotState = PINGSLOT_STATE_CALC_PING_OFFSET;
 }
 
 static void InitClassBDefaults( void )
@@ -450,9 +687,15 @@ static void InitClassBDefaults( void )
     // but should keep important configurations
     LoRaMacClassBBeaconNvmData_t beaconCtx = ClassBNvm->BeaconCtx;
     LoRaMacClassBPingSlotNvmData_t pingSlotCtx = ClassBNvm->PingSlotCtx;
+    BeaconDrift_t drift = Ctx.BeaconCtx.Drift;
 
     InitClassB( );
 
+    // The learned drift is a property of the RTC crystal. Keep it, but
+    // restart the measurement with the next beacon
+    Ctx.BeaconCtx.Drift = drift;
+    Ctx.BeaconCtx.Drift.LastRxDone = 0;
+
     // Parameters from BeaconFreqReq
     ClassBNvm->BeaconCtx.Frequency = beaconCtx.Frequency;
     ClassBNvm->BeaconCtx.Ctrl.CustomFreq = beaconCtx.Ctrl.CustomFreq;
@@ -482,6 +725,29 @@ static void EnlargeWindowTimeout( void )
     {
         Ctx.PingSlotCtx.SymbolTimeout = CLASSB_PING_SLOT_SYMBOL_TO_EXPANSION_MAX;
     }
+
+    if( IsDriftEstimated( ) == true )
+    {
+        // Size the beacon window from the drift uncertainty of the next beacon,
+        // the fixed expansion above is the upper limit
+        GetPhyParams_t getPhy;
+        PhyParam_t phyParam;
+        RxConfigParams_t rxConfig;
+        uint32_t maxRxError = CalcMaxRxError( CalcNextBeaconRxDone( ) );
+
+        getPhy.Attribute = PHY_BEACON_CHANNEL_DR;
+        phyParam = RegionGetPhyParam( *Ctx.LoRaMacClassBParams.LoRaMacRegion, &getPhy );
+        RegionComputeRxWindowParameters( *Ctx.LoRaMacClassBParams.LoRaMacRegion,
+                                         ( int8_t )phyParam.Value, // datarate
+                                         Ctx.LoRaMacClassBParams.LoRaMacParams->MinRxSymbols,
+                                         maxRxError,
+                                         &rxConfig );
+
+        Ctx.BeaconCtx.BeaconWindowMovement = MIN( Ctx.BeaconCtx.BeaconWindowMovement,
+                                                  MAX( maxRxError, CLASSB_WINDOW_MOVE_DEFAULT ) );
+        Ctx.BeaconCtx.SymbolTimeout = MIN( Ctx.BeaconCtx.SymbolTimeout,
+                                           MAX( rxConfig.WindowTimeout, CLASSB_BEACON_SYMBOL_TO_DEFAULT ) );
+    }
 }
 
 static void ResetWindowTimeout( void )
@@ -535,7 +801,7 @@ static TimerTime_t UpdateBeaconState( LoRaMacEventInfoStatus_t status,
     Ctx.BeaconCtx.NextBeaconRx = SysTimeFromMs( currentTime + beaconEventTime );
 
     // Take temperature compensation into account
-    beaconEventTime = TimerTempCompensation( beaconEventTime, Ctx.BeaconCtx.Temperature );
+    beaconEventTime = BeaconDriftCompensation( beaconEventTime );
 
     // Move the window
     if( beaconEventTime > windowMovement )
@@ -606,6 +872,141 @@ static bool CheckSlotPriority( uint32_t currentAddress, uint8_t currentFPendingS
     return false;
 }
 
+/*!
+ * \brief Gets the FPending bit of a ping slot source
+ *
+ * \param [IN] source Ping slot source
+ *
+ * \retval FPending bit
+ */
+static uint8_t GetPingSlotSourceFPendingSet( PingSlotSource_t *source )
+{
+    if( source->MulticastChannel != NULL )
+    {
+        return source->MulticastChannel->FPendingSet;
+    }
+    return ClassBNvm->PingSlotCtx.FPendingSet;
+}
+
+/*!
+ * \brief Builds the ping slot timeline of the current beacon period with the
+ *        unicast address and all enabled multicast channels.
+ */
+static void BuildPingSlotTimeline( void )
+{
+    PingSlotTimeline_t *timeline = &Ctx.PingSlotTimeline;
+    MulticastCtx_t *cur = Ctx.LoRaMacClassBParams.MulticastChannels;
+
+    UpdatePingOffsetCache( Ctx.BeaconCtx.BeaconTime.Seconds );
+
+    timeline->NbSources = 0;
+    timeline->NextSource = 0;
+
+    // Unicast
+    Ctx.PingSlotCtx.PingOffset = GetPingOffset( 0, ClassBNvm->PingSlotCtx.PingPeriod );
+    if( ClassBNvm->PingSlotCtx.Ctrl.Assigned == 1 )
+    {
+        timeline->Sources[timeline->NbSources].MulticastChannel = NULL;
+        timeline->Sources[timeline->NbSources].Address = *Ctx.LoRaMacClassBParams.LoRaMacDevAddr;
+        timeline->Sources[timeline->NbSources].PingOffset = Ctx.PingSlotCtx.PingOffset;
+        timeline->Sources[timeline->NbSources].PingPeriod = ClassBNvm->PingSlotCtx.PingPeriod;
+        timeline->Sources[timeline->NbSources].PingNb = ClassBNvm->PingSlotCtx.PingNb;
+        timeline->Sources[timeline->NbSources].Datarate = ClassBNvm->PingSlotCtx.Datarate;
+        timeline->NbSources++;
+    }
+
+    // Multicast channels
+    if( cur == NULL )
+    {
+        return;
+    }
+    for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+    {
+        cur->PingOffset = GetPingOffset( i + 1, cur->PingPeriod );
+        if( ( cur->ChannelParams.IsEnabled == true ) && ( cur->PingNb != 0 ) )
+        {
+            timeline->Sources[timeline->NbSources].MulticastChannel = cur;
+            timeline->Sources[timeline->NbSources].Address = cur->ChannelParams.Address;
+            timeline->Sources[timeline->NbSources].PingOffset = cur->PingOffset;
+            timeline->Sources[timeline->NbSources].PingPeriod = cur->PingPeriod;
+            timeline->Sources[timeline->NbSources].PingNb = cur->PingNb;
+            timeline->Sources[timeline->NbSources].Datarate = cur->ChannelParams.RxParams.ClassB.Datarate;
+            timeline->NbSources++;
+        }
+        cur++;
+    }
+}
+
+/*!
+ * \brief Calculates the next slot of the ping slot timeline. Sources sharing
+ *        the same slot are resolved by their priority.
+ *
+ * \param [OUT] timeOffset Time offset of the next slot, based on current time
+ *
+ * \retval Source index of the next slot. NbSources, if there is no slot
+ *         left in the beacon period
+ */
+static uint8_t CalcNextTimelineSlot( TimerTime_t* timeOffset )
+{
+    PingSlotTimeline_t *timeline = &Ctx.PingSlotTimeline;
+    uint8_t nextSource = timeline->NbSources;
+    uint32_t nextSlot = 0;
+    TimerTime_t currentTime = TimerGetCurrentTime( );
+    TimerTime_t firstSlotTime = 0;
+    TimerTime_t lastSlotTime = SysTimeToMs( Ctx.BeaconCtx.NextBeaconRx ) - CLASSB_BEACON_GUARD - CLASSB_PING_SLOT_WINDOW;
+
+    // Calculate the point in time of the last beacon even if we missed it
+    firstSlotTime = ( ( currentTime - SysTimeToMs( Ctx.BeaconCtx.LastBeaconRx ) ) % CLASSB_BEACON_INTERVAL );
+    firstSlotTime = currentTime - firstSlotTime;
+
+    // Add the reserved time
+    firstSlotTime += CLASSB_BEACON_RESERVED;
+
+    for( uint8_t i = 0; i < timeline->NbSources; i++ )
+    {
+        PingSlotSource_t *source = &timeline->Sources[i];
+        uint32_t slot = source->PingOffset;
+        uint16_t currentPingSlot = 0;
+        TimerTime_t slotTime = firstSlotTime + ( slot * CLASSB_PING_SLOT_WINDOW );
+
+        if( slotTime < currentTime )
+        {
+            currentPingSlot = ( ( currentTime - slotTime ) /
+                              ( source->PingPeriod * CLASSB_PING_SLOT_WINDOW ) ) + 1;
+            slot += ( uint32_t )currentPingSlot * source->PingPeriod;
+            slotTime = firstSlotTime + ( slot * CLASSB_PING_SLOT_WINDOW );
+        }
+
+        if( ( currentPingSlot >= source->PingNb ) || ( slotTime > lastSlotTime ) )
+        {
+            // No slot left in this beacon period
+            continue;
+        }
+
+        if( ( nextSource == timeline->NbSources ) || ( slot < nextSlot ) ||
+            ( ( slot == nextSlot ) &&
+              ( CheckSlotPriority( timeline->Sources[nextSource].Address, GetPingSlotSourceFPendingSet( &timeline->Sources[nextSource] ),
+                                   ( timeline->Sources[nextSource].MulticastChannel != NULL ) ? 1 : 0,
+                                   source->Address, GetPingSlotSourceFPendingSet( source ),
+                                   ( source->MulticastChannel != NULL ) ? 1 : 0 ) == true ) ) )
+        {
+            nextSource = i;
+            nextSlot = slot;
+        }
+    }
+
+    if( nextSource < timeline->NbSources )
+    {
+        // Calculate the relative ping slot time
+        TimerTime_t slotTime = firstSlotTime + ( nextSlot * CLASSB_PING_SLOT_WINDOW );
+
+        slotTime -= currentTime;
+        slotTime -= Radio.GetWakeupTime( );
+        *timeOffset = BeaconDriftCompensation( slotTime );
+    }
+    return nextSource;
+}
+
 #endif // LORAMAC_CLASSB_ENABLED
 
 void LoRaMacClassBInit( LoRaMacClassBParams_t *classBParams, LoRaMacClassBCallback_t *callbacks, LoRaMacClassBNvmData_t* nvm )
@@ -627,7 +1028,6 @@ void LoRaMacClassBInit( LoRaMacClassBParams_t *classBParams, LoRaMacClassBCallba
     // Initialize timers
     TimerInit( &Ctx.BeaconTimer, LoRaMacClassBBeaconTimerEvent );
     TimerInit( &Ctx.PingSlotTimer, LoRaMacClassBPingSlotTimerEvent );
-    TimerInit( &Ctx.MulticastSlotTimer, LoRaMacClassBMulticastSlotTimerEvent );
 
     InitClassB( );
 #endif // LORAMAC_CLASSB_ENABLED
@@ -671,7 +1071,8 @@ void LoRaMacClassBSetPingSlotState( PingSlotState_t pingSlotState )
 void LoRaMacClassBSetMulticastSlotState( PingSlotState_t multicastSlotState )
 {
 #ifdef LORAMAC_CLASSB_ENABLED
-    Ctx.MulticastSlotState = multicastSlotState;
+    // Unicast and multicast slots share the ping slot timeline
+    Ctx.PingSlotState = multicastSlotState;
 #endif // LORAMAC_CLASSB_ENABLED
 }
 
@@ -745,7 +1146,7 @@ static void LoRaMacClassBProcessBeacon( void )
                         if( SysTimeToMs( Ctx.BeaconCtx.NextBeaconRx ) > currentTime )
                         {
                             // Calculate the time when we expect the next beacon
-                            beaconEventTime = TimerTempCompensation( SysTimeToMs( Ctx.BeaconCtx.NextBeaconRx ) - currentTime, Ctx.BeaconCtx.Temperature );
+                            beaconEventTime = BeaconDriftCompensation( SysTimeToMs( Ctx.BeaconCtx.NextBeaconRx ) - currentTime );
 
                             if( ( int32_t ) beaconEventTime > beaconRxConfig.WindowOffset )
                             {
@@ -891,7 +1292,7 @@ static void LoRaMacClassBProcessBeacon( void )
             {
                 Ctx.BeaconState = BEACON_STATE_GUARD;
                 beaconEventTime -= currentTime;
-                beaconEventTime = TimerTempCompensation( beaconEventTime, Ctx.BeaconCtx.Temperature );
+                beaconEventTime = BeaconDriftCompensation( beaconEventTime );
 
                 if( ( int32_t ) beaconEventTime > beaconRxConfig.WindowOffset )
                 {
@@ -978,34 +1379,37 @@ static void LoRaMacClassBProcessPingSlot( void )
     static RxConfigParams_t pingSlotRxConfig;
     TimerTime_t pingSlotTime = 0;
     uint32_t maxRxError = 0;
-    bool slotHasPriority = false;
+    PingSlotTimeline_t *timeline = &Ctx.PingSlotTimeline;
+    PingSlotSource_t *source = NULL;
 
     switch( Ctx.PingSlotState )
     {
         case PINGSLOT_STATE_CALC_PING_OFFSET:
         {
-            ComputePingOffset( Ctx.BeaconCtx.BeaconTime.Seconds,
-                               *Ctx.LoRaMacClassBParams.LoRaMacDevAddr,
-                               ClassBNvm->PingSlotCtx.PingPeriod,
-                               &( Ctx.PingSlotCtx.PingOffset ) );
+            // Setup the slot sources of the beacon period
+            BuildPingSlotTimeline( );
             Ctx.PingSlotState = PINGSLOT_STATE_SET_TIMER;
         }
             // Intentional fall through
         case PINGSLOT_STATE_SET_TIMER:
         {
-            if( CalcNextSlotTime( Ctx.PingSlotCtx.PingOffset, ClassBNvm->PingSlotCtx.PingPeriod, ClassBNvm->PingSlotCtx.PingNb, &pingSlotTime ) == true )
+            timeline->NextSource = CalcNextTimelineSlot( &pingSlotTime );
+
+            if( timeline->NextSource < timeline->NbSources )
             {
-                if( Ctx.BeaconCtx.Ctrl.BeaconAcquired == 1 )
+                source = &timeline->Sources[timeline->NextSource];
+                Ctx.PingSlotCtx.NextMulticastChannel = source->MulticastChannel;
+
+                if( ( Ctx.BeaconCtx.Ctrl.BeaconAcquired == 1 ) || ( IsDriftEstimated( ) == true ) )
                 {
-                    // Compare and assign the maximum between the region specific rx error window time
-                    // and time precision received from beacon frame format.
-                    maxRxError = MAX( Ctx.LoRaMacClassBParams.LoRaMacParams->SystemMaxRxError ,
-                                      ( uint32_t ) Ctx.BeaconCtx.BeaconTimePrecision.SubSeconds );
+                    // Get the rx error of the slot window. With an estimated drift,
+                    // the window follows the uncertainty even if beacons are missed.
+                    maxRxError = CalcMaxRxError( TimerGetCurrentTime( ) + pingSlotTime );
 
                     // Compute the symbol timeout. Apply it only, if the beacon is acquired
                     // Otherwise, take the enlargement of the symbols into account.
                     RegionComputeRxWindowParameters( *Ctx.LoRaMacClassBParams.LoRaMacRegion,
-                                                     ClassBNvm->PingSlotCtx.Datarate,
+                                                     source->Datarate,
                                                      Ctx.LoRaMacClassBParams.LoRaMacParams->MinRxSymbols,
                                                      maxRxError,
                                                      &pingSlotRxConfig );
@@ -1026,62 +1430,50 @@ static void LoRaMacClassBProcessPingSlot( void )
         }
         case PINGSLOT_STATE_IDLE:
         {
-            uint32_t frequency = ClassBNvm->PingSlotCtx.Frequency;
+            uint32_t frequency = 0;
+            LoRaMacRxSlot_t rxSlot = RX_SLOT_WIN_CLASS_B_PING_SLOT;
+
+            source = &timeline->Sources[timeline->NextSource];
 
-            // Apply a custom frequency if the following bit is set
-            if( ClassBNvm->PingSlotCtx.Ctrl.CustomFreq == 0 )
+            if( source->MulticastChannel != NULL )
             {
-                // Restore floor plan
-                frequency = CalcDownlinkChannelAndFrequency( *Ctx.LoRaMacClassBParams.LoRaMacDevAddr, Ctx.BeaconCtx.BeaconTime.Seconds,
-                                                             CLASSB_BEACON_INTERVAL, false );
+                // Apply the frequency of the multicast channel
+                frequency = source->MulticastChannel->ChannelParams.RxParams.ClassB.Frequency;
+                rxSlot = RX_SLOT_WIN_CLASS_B_MULTICAST_SLOT;
             }
-
-            if( Ctx.PingSlotCtx.NextMulticastChannel != NULL )
+            else if( ClassBNvm->PingSlotCtx.Ctrl.CustomFreq == 1 )
             {
-                // Verify, if the unicast has priority.
-                slotHasPriority = CheckSlotPriority( *Ctx.LoRaMacClassBParams.LoRaMacDevAddr, ClassBNvm->PingSlotCtx.FPendingSet, 0,
-                                                     Ctx.PingSlotCtx.NextMulticastChannel->ChannelParams.Address, Ctx.PingSlotCtx.NextMulticastChannel->FPendingSet, 1 );
+                // Apply a custom frequency
+                frequency = ClassBNvm->PingSlotCtx.Frequency;
             }
 
-            // Open the ping slot window only, if there is no multicast ping slot
-            // open or if the unicast has priority.
-            if( ( Ctx.MulticastSlotState != PINGSLOT_STATE_RX ) || ( slotHasPriority == true ) )
+            // Restore the floor plan frequency if there is no individual frequency assigned
+            if( frequency == 0 )
             {
-                if( Ctx.MulticastSlotState == PINGSLOT_STATE_RX )
-                {
-                    // Close multicast slot window, if necessary. Multicast slots have priority
-                    Radio.Standby( );
-                    Ctx.MulticastSlotState = PINGSLOT_STATE_CALC_PING_OFFSET;
-                    TimerSetValue( &Ctx.MulticastSlotTimer, CLASSB_PING_SLOT_WINDOW );
-                    TimerStart( &Ctx.MulticastSlotTimer );
-                }
+                frequency = CalcDownlinkChannelAndFrequency( source->Address, Ctx.BeaconCtx.BeaconTime.Seconds,
+                                                             CLASSB_BEACON_INTERVAL, false );
+            }
 
-                Ctx.PingSlotState = PINGSLOT_STATE_RX;
+            // Priorities were resolved by the timeline, open the slot window
+            Ctx.PingSlotState = PINGSLOT_STATE_RX;
 
-                pingSlotRxConfig.Datarate = ClassBNvm->PingSlotCtx.Datarate;
-                pingSlotRxConfig.DownlinkDwellTime = Ctx.LoRaMacClassBParams.LoRaMacParams->DownlinkDwellTime;
-                pingSlotRxConfig.Frequency = frequency;
-                pingSlotRxConfig.RxContinuous = false;
-                pingSlotRxConfig.RxSlot = RX_SLOT_WIN_CLASS_B_PING_SLOT;
-                pingSlotRxConfig.NetworkActivation = *Ctx.LoRaMacClassBParams.NetworkActivation;
+            pingSlotRxConfig.Datarate = source->Datarate;
+            pingSlotRxConfig.DownlinkDwellTime = Ctx.LoRaMacClassBParams.LoRaMacParams->DownlinkDwellTime;
+            pingSlotRxConfig.Frequency = frequency;
+            pingSlotRxConfig.RxContinuous = false;
+            pingSlotRxConfig.PreambleLength = REGION_COMMON_DEFAULT_PREAMBLE_LENGTH;
+            pingSlotRxConfig.RxSlot = rxSlot;
+            pingSlotRxConfig.NetworkActivation = *Ctx.LoRaMacClassBParams.NetworkActivation;
 
-                RegionRxConfig( *Ctx.LoRaMacClassBParams.LoRaMacRegion, &pingSlotRxConfig, ( int8_t* )&Ctx.LoRaMacClassBParams.McpsIndication->RxDatarate );
+            RegionRxConfig( *Ctx.LoRaMacClassBParams.LoRaMacRegion, &pingSlotRxConfig, ( int8_t* )&Ctx.LoRaMacClassBParams.McpsIndication->RxDatarate );
 
-                if( pingSlotRxConfig.RxContinuous == false )
-                {
-                    Radio.Rx( Ctx.LoRaMacClassBParams.LoRaMacParams->MaxRxWindow );
-                }
-                else
-                {
-                    Radio.Rx( 0 ); // Continuous mode
-                }
+            if( pingSlotRxConfig.RxContinuous == false )
+            {
+                Radio.Rx( Ctx.LoRaMacClassBParams.LoRaMacParams->MaxRxWindow );
             }
             else
             {
-                // Multicast slots have priority. Skip Rx
-                Ctx.PingSlotState = PINGSLOT_STATE_CALC_PING_OFFSET;
-                TimerSetValue( &Ctx.PingSlotTimer, CLASSB_PING_SLOT_WINDOW );
-                TimerStart( &Ctx.PingSlotTimer );
+                Radio.Rx( 0 ); // Continuous mode
             }
             break;
         }
@@ -1096,184 +1488,11 @@ static void LoRaMacClassBProcessPingSlot( void )
 
 void LoRaMacClassBMulticastSlotTimerEvent( void* context )
 {
-#ifdef LORAMAC_CLASSB_ENABLED
-    LoRaMacClassBEvents.Events.MulticastSlot = 1;
-
-    if( Ctx.LoRaMacClassBCallbacks.MacProcessNotify != NULL )
-    {
-        Ctx.LoRaMacClassBCallbacks.MacProcessNotify( );
-    }
-#endif // LORAMAC_CLASSB_ENABLED
+    // Unicast and multicast slots share the ping slot timeline
+    LoRaMacClassBPingSlotTimerEvent( context );
 }
 
-#ifdef LORAMAC_CLASSB_ENABLED
-static void LoRaMacClassBProcessMulticastSlot( void )
-{
-    static RxConfigParams_t multicastSlotRxConfig;
-    TimerTime_t multicastSlotTime = 0;
-    TimerTime_t slotTime = 0;
-    uint32_t maxRxError = 0;
-    MulticastCtx_t *cur = Ctx.LoRaMacClassBParams.MulticastChannels;
-    bool slotHasPriority = false;
-
-    if( cur == NULL )
-    {
-        return;
-    }
-
-    if( Ctx.MulticastSlotState == PINGSLOT_STATE_RX )
-    {
-        // A multicast slot is already open
-        return;
-    }
-
-    switch( Ctx.MulticastSlotState )
-    {
-        case PINGSLOT_STATE_CALC_PING_OFFSET:
-        {
-            // Compute all offsets for every multicast slots
-            for( uint8_t i = 0; i < 4; i++ )
-            {
-                ComputePingOffset( Ctx.BeaconCtx.BeaconTime.Seconds,
-                                   cur->ChannelParams.Address,
-                                   cur->PingPeriod,
-                                   &( cur->PingOffset ) );
-                cur++;
-            }
-            Ctx.MulticastSlotState = PINGSLOT_STATE_SET_TIMER;
-        }
-            // Intentional fall through
-        case PINGSLOT_STATE_SET_TIMER:
-        {
-            cur = Ctx.LoRaMacClassBParams.MulticastChannels;
-            Ctx.PingSlotCtx.NextMulticastChannel = NULL;
-
-            for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
-            {
-                // Calculate the next slot time for every multicast slot
-                if( CalcNextSlotTime( cur->PingOffset, cur->PingPeriod, cur->PingNb, &slotTime ) == true )
-                {
-                    if( ( multicastSlotTime == 0 ) || ( multicastSlotTime > slotTime ) )
-                    {
-                        // Update the slot time and the next multicast channel
-                        multicastSlotTime = slotTime;
-                        Ctx.PingSlotCtx.NextMulticastChannel = cur;
-                    }
-                }
-                cur++;
-            }
-
-            // Schedule the next multicast slot
-            if( Ctx.PingSlotCtx.NextMulticastChannel != NULL )
-            {
-                if( Ctx.BeaconCtx.Ctrl.BeaconAcquired == 1 )
-                {
-
-                    // Compare and assign the maximum between the region specific rx error window time
-                    // and time precision received from beacon frame format.
-                    maxRxError = MAX( Ctx.LoRaMacClassBParams.LoRaMacParams->SystemMaxRxError ,
-                                      ( uint32_t ) Ctx.BeaconCtx.BeaconTimePrecision.SubSeconds );
-
-                    RegionComputeRxWindowParameters( *Ctx.LoRaMacClassBParams.LoRaMacRegion,
-                                                    ClassBNvm->PingSlotCtx.Datarate,
-                                                    Ctx.LoRaMacClassBParams.LoRaMacParams->MinRxSymbols,
-                                                    maxRxError,
-                                                    &multicastSlotRxConfig );
-                    Ctx.PingSlotCtx.SymbolTimeout = multicastSlotRxConfig.WindowTimeout;
-                }
-
-                if( ( int32_t )multicastSlotTime > multicastSlotRxConfig.WindowOffset )
-                {// Apply the window offset
-                    multicastSlotTime += multicastSlotRxConfig.WindowOffset;
-                }
-
-                // Start the timer if the ping slot time is in range
-                Ctx.MulticastSlotState = PINGSLOT_STATE_IDLE;
-                TimerSetValue( &Ctx.MulticastSlotTimer, multicastSlotTime );
-                TimerStart( &Ctx.MulticastSlotTimer );
-            }
-            break;
-        }
-        case PINGSLOT_STATE_IDLE:
-        {
-            uint32_t frequency = 0;
-
-            // Verify if the multicast channel is valid
-            if( Ctx.PingSlotCtx.NextMulticastChannel == NULL )
-            {
-                Ctx.MulticastSlotState = PINGSLOT_STATE_CALC_PING_OFFSET;
-                TimerSetValue( &Ctx.MulticastSlotTimer, 1 );
-                TimerStart( &Ctx.MulticastSlotTimer );
-                break;
-            }
-
-            // Apply frequency
-            frequency = Ctx.PingSlotCtx.NextMulticastChannel->ChannelParams.RxParams.ClassB.Frequency;
-
-            // Restore the floor plan frequency if there is no individual frequency assigned
-            if( frequency == 0 )
-            {
-                // Restore floor plan
-                frequency = CalcDownlinkChannelAndFrequency( Ctx.PingSlotCtx.NextMulticastChannel->ChannelParams.Address,
-                                                             Ctx.BeaconCtx.BeaconTime.Seconds, CLASSB_BEACON_INTERVAL, false );
-            }
-
-            // Verify, if the unicast has priority.
-            slotHasPriority = CheckSlotPriority( Ctx.PingSlotCtx.NextMulticastChannel->ChannelParams.Address, Ctx.PingSlotCtx.NextMulticastChannel->FPendingSet, 1,
-                                                 *Ctx.LoRaMacClassBParams.LoRaMacDevAddr, ClassBNvm->PingSlotCtx.FPendingSet, 0 );
-
-            // Open the ping slot window only, if there is no multicast ping slot
-            // open or if the unicast has priority.
-            if( ( Ctx.PingSlotState != PINGSLOT_STATE_RX ) || ( slotHasPriority == true ) )
-            {
-                if( Ctx.PingSlotState == PINGSLOT_STATE_RX )
-                {
-                    // Close ping slot window, if necessary. Multicast slots have priority
-                    Radio.Standby( );
-                    Ctx.PingSlotState = PINGSLOT_STATE_CALC_PING_OFFSET;
-                    TimerSetValue( &Ctx.PingSlotTimer, CLASSB_PING_SLOT_WINDOW );
-                    TimerStart( &Ctx.PingSlotTimer );
-                }
-
-                Ctx.MulticastSlotState = PINGSLOT_STATE_RX;
-
-                multicastSlotRxConfig.Datarate = Ctx.PingSlotCtx.NextMulticastChannel->ChannelParams.RxParams.ClassB.Datarate;
-                multicastSlotRxConfig.DownlinkDwellTime = Ctx.LoRaMacClassBParams.LoRaMacParams->DownlinkDwellTime;
-                multicastSlotRxConfig.Frequency = frequency;
-                multicastSlotRxConfig.RxContinuous = false;
-                multicastSlotRxConfig.RxSlot = RX_SLOT_WIN_CLASS_B_MULTICAST_SLOT;
-                multicastSlotRxConfig.NetworkActivation = *Ctx.LoRaMacClassBParams.NetworkActivation;
-
-                RegionRxConfig( *Ctx.LoRaMacClassBParams.LoRaMacRegion, &multicastSlotRxConfig, ( int8_t* )&Ctx.LoRaMacClassBParams.McpsIndication->RxDatarate );
-
-                if( multicastSlotRxConfig.RxContinuous == false )
-                {
-                    Radio.Rx( Ctx.LoRaMacClassBParams.LoRaMacParams->MaxRxWindow );
-                }
-                else
-                {
-                    Radio.Rx( 0 ); // Continuous mode
-                }
-            }
-            else
-            {
-                // Unicast slots have priority. Skip Rx
-                Ctx.MulticastSlotState = PINGSLOT_STATE_CALC_PING_OFFSET;
-                TimerSetValue( &Ctx.MulticastSlotTimer, CLASSB_PING_SLOT_WINDOW );
-                TimerStart( &Ctx.MulticastSlotTimer );
-            }
-            break;
-        }
-        default:
-        {
-            Ctx.MulticastSlotState = PINGSLOT_STATE_CALC_PING_OFFSET;
-            break;
-        }
-    }
-}
-#endif // LORAMAC_CLASSB_ENABLED
-
-bool LoRaMacClassBRxBeacon( uint8_t *payload, uint16_t size )
+bool LoRaMacClassBRxBeacon( uint8_t *payload, uint16_t size, TimerTime_t rxDoneTime )
 {
 #ifdef LORAMAC_CLASSB_ENABLED
     GetPhyParams_t getPhy;
@@ -1365,6 +1584,9 @@ bool LoRaMacClassBRxBeacon( uint8_t *payload, uint16_t size )
                 // Update system time.
                 SysTimeSet( SysTimeAdd( Ctx.BeaconCtx.LastBeaconRx, timeOnAir ) );
 
+                // Learn the RTC drift from the beacon reception
+                UpdateBeaconDrift( rxDoneTime );
+
                 Ctx.BeaconCtx.Ctrl.BeaconAcquired = 1;
                 Ctx.BeaconCtx.Ctrl.BeaconMode = 1;
                 ResetWindowTimeout( );
@@ -1411,7 +1633,8 @@ bool LoRaMacClassBIsBeaconExpected( void )
 bool LoRaMacClassBIsPingExpected( void )
 {
 #ifdef LORAMAC_CLASSB_ENABLED
-    if( Ctx.PingSlotState == PINGSLOT_STATE_RX )
+    if( ( Ctx.PingSlotState == PINGSLOT_STATE_RX ) &&
+        ( Ctx.PingSlotCtx.NextMulticastChannel == NULL ) )
     {
         return true;
     }
@@ -1424,7 +1647,8 @@ bool LoRaMacClassBIsPingExpected( void )
 bool LoRaMacClassBIsMulticastExpected( void )
 {
 #ifdef LORAMAC_CLASSB_ENABLED
-    if( Ctx.MulticastSlotState == PINGSLOT_STATE_RX )
+    if( ( Ctx.PingSlotState == PINGSLOT_STATE_RX ) &&
+        ( Ctx.PingSlotCtx.NextMulticastChannel != NULL ) )
     {
         return true;
     }
@@ -1768,11 +1992,9 @@ void LoRaMacClassBStopRxSlots( void )
 {
 #ifdef LORAMAC_CLASSB_ENABLED
     TimerStop( &Ctx.PingSlotTimer );
-    TimerStop( &Ctx.MulticastSlotTimer );
 
     CRITICAL_SECTION_BEGIN( );
     LoRaMacClassBEvents.Events.PingSlot = 0;
-    LoRaMacClassBEvents.Events.MulticastSlot = 0;
     CRITICAL_SECTION_END( );
 #endif // LORAMAC_CLASSB_ENABLED
 }
@@ -1785,10 +2007,6 @@ void LoRaMacClassBStartRxSlots( void )
         Ctx.PingSlotState = PINGSLOT_STATE_CALC_PING_OFFSET;
         TimerSetValue( &Ctx.PingSlotTimer, 1 );
         TimerStart( &Ctx.PingSlotTimer );
-
-        Ctx.MulticastSlotState = PINGSLOT_STATE_CALC_PING_OFFSET;
-        TimerSetValue( &Ctx.MulticastSlotTimer, 1 );
-        TimerStart( &Ctx.MulticastSlotTimer );
     }
 #endif // LORAMAC_CLASSB_ENABLED
 }
@@ -1814,19 +2032,14 @@ void LoRaMacClassBSetFPendingBit( uint32_t address, uint8_t fPendingSet )
         // Unicast
         ClassBNvm->PingSlotCtx.FPendingSet = fPendingSet;
     }
-    else
+    else if( cur != NULL )
     {
-        for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+        // Set the fPending bit, if its a multicast
+        uint8_t groupId = LoRaMacMcChannelGetGroupId( address );
+
+        if( groupId < LORAMAC_MAX_MC_CTX )
         {
-            if( cur != NULL )
-            {
-                // Set the fPending bit, if its a multicast
-                if( address == cur->ChannelParams.Address )
-                {
-                    cur->FPendingSet = fPendingSet;
-                }
-            }
-            cur++;
+            cur[groupId].FPendingSet = fPendingSet;
         }
     }
 #endif
@@ -1852,10 +2065,15 @@ void LoRaMacClassBProcess( void )
         {
             LoRaMacClassBProcessPingSlot( );
         }
-        if( events.Events.MulticastSlot == 1 )
-        {
-            LoRaMacClassBProcessMulticastSlot( );
-        }
     }
 #endif // LORAMAC_CLASSB_ENABLED
 }
+
+bool LoRaMacClassBHasPendingEvents( void )
+{
+#ifdef LORAMAC_CLASSB_ENABLED
+    return ( LoRaMacClassBEvents.Value != 0 );
+#else
+    return false;
+#endif // LORAMAC_CLASSB_ENABLED
+}
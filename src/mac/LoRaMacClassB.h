@@ -141,12 +141,36 @@ typedef struct sPingSlotContext
      */
     uint16_t SymbolTimeout;
     /*!
-     * The multicast channel which will be enabled next.
+     * The multicast channel which will be enabled next. NULL, if the next
+     * slot is a unicast ping slot.
      */
     MulticastCtx_t *NextMulticastChannel;
 }PingSlotContext_t;
 
 
+/*!
+ * Class B beacon drift estimator structure
+ */
+typedef struct sBeaconDrift
+{
+    /*!
+     * Timer time of the RxDone of the last received beacon
+     */
+    TimerTime_t LastRxDone;
+    /*!
+     * Estimated RTC drift in ppm, on top of the temperature compensation
+     */
+    float Ppm;
+    /*!
+     * Mean absolute deviation of the drift samples in ppm
+     */
+    float DevPpm;
+    /*!
+     * Number of drift samples taken into account
+     */
+    uint8_t NbSamples;
+}BeaconDrift_t;
+
 /*!
  * Class B beacon context structure
  */
@@ -225,6 +249,10 @@ typedef struct sBeaconContext
      * param field of beacon frame format.
      */
     SysTime_t BeaconTimePrecision;
+    /*!
+     * RTC drift learned from the beacon receptions
+     */
+    BeaconDrift_t Drift;
 }BeaconContext_t;
 
 /*!
@@ -321,7 +349,8 @@ void LoRaMacClassBSetBeaconState( BeaconState_t beaconState );
 void LoRaMacClassBSetPingSlotState( PingSlotState_t pingSlotState );
 
 /*!
- * \brief Set the state of the multicast slot state machine
+ * \brief Set the state of the multicast slot state machine. Unicast and
+ *        multicast slots share the ping slot state machine.
  *
  * \param [IN] pingSlotState multicast slot state.
  */
@@ -345,7 +374,8 @@ void LoRaMacClassBBeaconTimerEvent( void* context );
 void LoRaMacClassBPingSlotTimerEvent( void* context );
 
 /*!
- * \brief State machine of the Class B for multicast slots
+ * \brief State machine of the Class B for multicast slots. Unicast and
+ *        multicast slots share the ping slot state machine.
  */
 void LoRaMacClassBMulticastSlotTimerEvent( void* context );
 
@@ -354,9 +384,10 @@ void LoRaMacClassBMulticastSlotTimerEvent( void* context );
  *
  * \param [IN] payload Pointer to the payload
  * \param [IN] size Size of the payload
+ * \param [IN] rxDoneTime Timer time of the RxDone event
  * \retval [true, if the node has received a beacon; false, if not]
  */
-bool LoRaMacClassBRxBeacon( uint8_t *payload, uint16_t size );
+bool LoRaMacClassBRxBeacon( uint8_t *payload, uint16_t size, TimerTime_t rxDoneTime );
 
 /*!
  * \brief The function validates, if the node expects a beacon
@@ -537,6 +568,14 @@ void LoRaMacClassBSetFPendingBit( uint32_t address, uint8_t fPendingSet );
  */
 void LoRaMacClassBProcess( void );
 
+/*!
+ * \brief Returns a value indicating if Class B events are pending and
+ *        \ref LoRaMacClassBProcess has to be called.
+ *
+ * \retval [true: events pending, false: no events pending]
+ */
+bool LoRaMacClassBHasPendingEvents( void );
+
 #ifdef __cplusplus
 }
 #endif
@@ -117,6 +117,35 @@ extern "C"
  */
 #define CLASSB_WINDOW_MOVE_EXPANSION_FACTOR         2
 
+/*!
+ * Number of beacon drift samples required before the drift estimator
+ * is used to size the RX windows
+ */
+#define CLASSB_DRIFT_MIN_NB_SAMPLES                 4
+
+/*!
+ * Filter factor of the beacon drift estimator. Each new sample
+ * contributes 1 / CLASSB_DRIFT_FILTER_FACTOR to the estimation
+ */
+#define CLASSB_DRIFT_FILTER_FACTOR                  8
+
+/*!
+ * Constant timing error in ms of the beacon drift estimator. Covers the
+ * timer resolution and the RxDone processing jitter
+ */
+#define CLASSB_DRIFT_TIMING_ERROR                   2
+
+/*!
+ * Minimum drift uncertainty in ppm
+ */
+#define CLASSB_DRIFT_MIN_DEV_PPM                    1.0f
+
+/*!
+ * Multiplier applied to the mean absolute drift deviation to get the
+ * drift uncertainty
+ */
+#define CLASSB_DRIFT_DEV_FACTOR                     4.0f
+
 #ifdef __cplusplus
 }
 #endif
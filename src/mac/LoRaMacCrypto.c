@@ -59,7 +59,7 @@
 /*
  * Number of security context entries
  */
-#define NUM_OF_SEC_CTX                  5
+#define NUM_OF_SEC_CTX                  ( UNICAST_DEV_ADDR + 1 )
 
 /*
  * Maximum size of the message that can be handled by the crypto operations
@@ -107,16 +107,10 @@ static uint16_t RJcount0;
 static LoRaMacCryptoNvmData_t* CryptoNvm;
 
 /*
- * Key-Address list
+ * Key-Address list, indexed by address identifier.
+ * Initialized by LoRaMacCryptoInit.
  */
-static KeyAddr_t KeyAddrList[NUM_OF_SEC_CTX] =
-    {
-        { MULTICAST_0_ADDR, MC_APP_S_KEY_0, MC_NWK_S_KEY_0, MC_KEY_0 },
-        { MULTICAST_1_ADDR, MC_APP_S_KEY_1, MC_NWK_S_KEY_1, MC_KEY_1 },
-        { MULTICAST_2_ADDR, MC_APP_S_KEY_2, MC_NWK_S_KEY_2, MC_KEY_2 },
-        { MULTICAST_3_ADDR, MC_APP_S_KEY_3, MC_NWK_S_KEY_3, MC_KEY_3 },
-        { UNICAST_DEV_ADDR, APP_S_KEY, S_NWK_S_INT_KEY, NO_KEY }
-    };
+static KeyAddr_t KeyAddrList[NUM_OF_SEC_CTX];
 
 /*
  * Encrypts the payload
@@ -510,17 +504,35 @@ static LoRaMacCryptoStatus_t ComputeCmacB1( uint8_t* msg, uint16_t len, KeyIdent
  */
 static LoRaMacCryptoStatus_t GetKeyAddrItem( AddressIdentifier_t addrID, KeyAddr_t** item )
 {
-    for( uint8_t i = 0; i < NUM_OF_SEC_CTX; i++ )
+    if( ( addrID < NUM_OF_SEC_CTX ) && ( KeyAddrList[addrID].AddrID == addrID ) )
     {
-        if( KeyAddrList[i].AddrID == addrID )
-        {
-            *item = &( KeyAddrList[i] );
-            return LORAMAC_CRYPTO_SUCCESS;
-        }
+        *item = &( KeyAddrList[addrID] );
+        return LORAMAC_CRYPTO_SUCCESS;
     }
     return LORAMAC_CRYPTO_ERROR_INVALID_ADDR_ID;
 }
 
+/*
+ * Initializes the Key-Address list
+ */
+static void InitKeyAddrList( void )
+{
+    memset1( ( uint8_t* )KeyAddrList, 0, sizeof( KeyAddrList ) );
+
+    for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+    {
+        KeyAddrList[i].AddrID = ( AddressIdentifier_t )i;
+        KeyAddrList[i].AppSkey = LORAMAC_MC_APP_S_KEY_ID( i );
+        KeyAddrList[i].NwkSkey = LORAMAC_MC_NWK_S_KEY_ID( i );
+        KeyAddrList[i].RootKey = LORAMAC_MC_KEY_ID( i );
+    }
+
+    KeyAddrList[UNICAST_DEV_ADDR].AddrID = UNICAST_DEV_ADDR;
+    KeyAddrList[UNICAST_DEV_ADDR].AppSkey = APP_S_KEY;
+    KeyAddrList[UNICAST_DEV_ADDR].NwkSkey = S_NWK_S_INT_KEY;
+    KeyAddrList[UNICAST_DEV_ADDR].RootKey = NO_KEY;
+}
+
 /*
  * Derives a session key as of LoRaWAN versions prior to 1.1.0
  *
@@ -662,6 +674,34 @@ static LoRaMacCryptoStatus_t DeriveLifeTimeSessionKey( KeyIdentifier_t keyID, ui
 }
 #endif
 
+/*
+ * Gets the multicast index of a multicast downlink frame counter
+ *
+ * \param[IN]     fCntID       - Frame counter identifier
+ *
+ * \retval                     - Multicast index. LORAMAC_MAX_MC_CTX if fCntID
+ *                               isn't a multicast downlink frame counter.
+ */
+static uint8_t GetMcFCntDownIndex( FCntIdentifier_t fCntID )
+{
+    uint32_t index = LORAMAC_MAX_MC_CTX;
+
+    if( ( fCntID >= MC_FCNT_DOWN_0 ) && ( fCntID <= MC_FCNT_DOWN_3 ) )
+    {
+        index = fCntID - MC_FCNT_DOWN_0;
+    }
+    else if( fCntID >= MC_FCNT_DOWN_EXT )
+    {
+        index = 4 + ( fCntID - MC_FCNT_DOWN_EXT );
+    }
+
+    if( index > LORAMAC_MAX_MC_CTX )
+    {
+        index = LORAMAC_MAX_MC_CTX;
+    }
+    return ( uint8_t )index;
+}
+
 /*
  * Gets the last received frame counter
  *
@@ -690,28 +730,17 @@ static LoRaMacCryptoStatus_t GetLastFcntDown( FCntIdentifier_t fCntID, uint32_t*
             *lastDown = CryptoNvm->FCntList.FCntDown;
             CryptoNvm->LastDownFCnt = CryptoNvm->FCntList.FCntDown;
             break;
-#if ( LORAMAC_MAX_MC_CTX > 0 )
-        case MC_FCNT_DOWN_0:
-            *lastDown = CryptoNvm->FCntList.McFCntDown[0];
-            break;
-#endif
-#if ( LORAMAC_MAX_MC_CTX > 1 )
-        case MC_FCNT_DOWN_1:
-            *lastDown = CryptoNvm->FCntList.McFCntDown[1];
-            break;
-#endif
-#if ( LORAMAC_MAX_MC_CTX > 2 )
-        case MC_FCNT_DOWN_2:
-            *lastDown = CryptoNvm->FCntList.McFCntDown[2];
-            break;
-#endif
-#if ( LORAMAC_MAX_MC_CTX > 3 )
-        case MC_FCNT_DOWN_3:
-            *lastDown = CryptoNvm->FCntList.McFCntDown[3];
-            break;
-#endif
         default:
-            return LORAMAC_CRYPTO_FAIL_FCNT_ID;
+        {
+            uint8_t mcIndex = GetMcFCntDownIndex( fCntID );
+
+            if( mcIndex >= LORAMAC_MAX_MC_CTX )
+            {
+                return LORAMAC_CRYPTO_FAIL_FCNT_ID;
+            }
+            *lastDown = CryptoNvm->FCntList.McFCntDown[mcIndex];
+            break;
+        }
     }
     return LORAMAC_CRYPTO_SUCCESS;
 }
@@ -764,28 +793,16 @@ static void UpdateFCntDown( FCntIdentifier_t fCntID, uint32_t currentDown )
         case FCNT_DOWN:
             CryptoNvm->FCntList.FCntDown = currentDown;
             break;
-#if ( LORAMAC_MAX_MC_CTX > 0 )
-        case MC_FCNT_DOWN_0:
-            CryptoNvm->FCntList.McFCntDown[0] = currentDown;
-            break;
-#endif
-#if ( LORAMAC_MAX_MC_CTX > 1 )
-        case MC_FCNT_DOWN_1:
-            CryptoNvm->FCntList.McFCntDown[1] = currentDown;
-            break;
-#endif
-#if ( LORAMAC_MAX_MC_CTX > 2 )
-        case MC_FCNT_DOWN_2:
-            CryptoNvm->FCntList.McFCntDown[2] = currentDown;
-            break;
-#endif
-#if ( LORAMAC_MAX_MC_CTX > 3 )
-        case MC_FCNT_DOWN_3:
-            CryptoNvm->FCntList.McFCntDown[3] = currentDown;
-            break;
-#endif
         default:
+        {
+            uint8_t mcIndex = GetMcFCntDownIndex( fCntID );
+
+            if( mcIndex < LORAMAC_MAX_MC_CTX )
+            {
+                CryptoNvm->FCntList.McFCntDown[mcIndex] = currentDown;
+            }
             break;
+        }
     }
 }
 
@@ -831,6 +848,9 @@ LoRaMacCryptoStatus_t LoRaMacCryptoInit( LoRaMacCryptoNvmData_t* nvm )
     // Reset frame counters
     ResetFCnts( );
 
+    // Initialize the security contexts
+    InitKeyAddrList( );
+
     return LORAMAC_CRYPTO_SUCCESS;
 }
 
@@ -234,6 +234,8 @@ typedef struct sLoRaMacMessageData
     uint8_t FPort;
     /*!
      * Frame payload may contain MAC commands or data (opt.)
+     *
+     * \remark When parsed, it points into Buffer.
      */
     uint8_t* FRMPayload;
     /*!
@@ -98,14 +98,17 @@ LoRaMacParserStatus_t LoRaMacParserData( LoRaMacMessageData_t* macMsg )
 
     // Initialize anyway with zero.
     macMsg->FPort = 0;
+    macMsg->FRMPayload = 0;
     macMsg->FRMPayloadSize = 0;
 
     if( ( macMsg->BufSize - bufItr - LORAMAC_MIC_FIELD_SIZE ) > 0 )
     {
         macMsg->FPort = macMsg->Buffer[bufItr++];
 
+        // FRMPayload is not copied. It references the serialized buffer in order
+        // to be decrypted in place.
         macMsg->FRMPayloadSize = ( macMsg->BufSize - bufItr - LORAMAC_MIC_FIELD_SIZE );
-        memcpy1( macMsg->FRMPayload, &macMsg->Buffer[bufItr], macMsg->FRMPayloadSize );
+        macMsg->FRMPayload = &macMsg->Buffer[bufItr];
         bufItr = bufItr + macMsg->FRMPayloadSize;
     }
 
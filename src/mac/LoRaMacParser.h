@@ -80,6 +80,10 @@ LoRaMacParserStatus_t LoRaMacParserJoinAccept( LoRaMacMessageJoinAccept_t *macMs
 /*!
  * Parse a serialized data message and fills the structured object.
  *
+ * \remark The FRMPayload field is not copied. It points into the serialized
+ *         message buffer ( macMsg->Buffer ), hence the buffer must remain
+ *         valid as long as the message object is used.
+ *
  * \param[IN/OUT] macMsg       - Data message object
  * \retval                     - Status of the operation
  */
@@ -57,8 +57,18 @@ extern "C"
 
 /*!
  * Maximum number of multicast context
+ *
+ * \remark Contexts 0 to 3 use the dedicated key and frame counter identifiers.
+ *         Contexts 4 and above use the extended identifier ranges starting at
+ *         \ref MC_KEY_EXT and \ref MC_FCNT_DOWN_EXT.
  */
+#ifndef LORAMAC_MAX_MC_CTX
 #define LORAMAC_MAX_MC_CTX                          4
+#endif
+
+#if ( LORAMAC_MAX_MC_CTX < 1 ) || ( LORAMAC_MAX_MC_CTX > 32 )
+#error "LORAMAC_MAX_MC_CTX must be in the range [1, 32]"
+#endif
 
 /*!
  * Region       | SF
@@ -672,6 +682,11 @@ typedef enum eFCntIdentifier
      * RJcount0 is a counter incremented with every transmitted Type 0 or 2 Rejoin request.
      */
     RJ_COUNT_1,
+    /*!
+     * Multicast downlink counter for index 4. The counters of the following
+     * indexes are consecutive.
+     */
+    MC_FCNT_DOWN_EXT,
 }FCntIdentifier_t;
 
 /*!
@@ -775,6 +790,11 @@ typedef enum eKeyIdentifier
      * No Key
      */
     NO_KEY,
+    /*!
+     * Multicast root key index 4. The following indexes use consecutive
+     * root key, application session key and network session key triples.
+     */
+    MC_KEY_EXT,
 }KeyIdentifier_t;
 
 /*!
@@ -800,10 +820,37 @@ typedef enum eAddressIdentifier
     MULTICAST_3_ADDR = 3,
     /*!
      * Unicast End-device address
+     *
+     * \remark Multicast indexes 4 and above are used as is, the unicast
+     *         identifier follows the last multicast index.
      */
-    UNICAST_DEV_ADDR = 4,
+    UNICAST_DEV_ADDR = ( LORAMAC_MAX_MC_CTX > 4 ) ? LORAMAC_MAX_MC_CTX : 4,
 }AddressIdentifier_t;
 
+/*!
+ * Multicast root key identifier of the given multicast index
+ */
+#define LORAMAC_MC_KEY_ID( idx )                    ( ( KeyIdentifier_t )( ( ( idx ) < 4 ) ?                          \
+                                                      ( MC_KEY_0 + ( 3 * ( idx ) ) ) :                                \
+                                                      ( MC_KEY_EXT + ( 3 * ( ( idx ) - 4 ) ) ) ) )
+
+/*!
+ * Multicast application session key identifier of the given multicast index
+ */
+#define LORAMAC_MC_APP_S_KEY_ID( idx )              ( ( KeyIdentifier_t )( LORAMAC_MC_KEY_ID( idx ) + 1 ) )
+
+/*!
+ * Multicast network session key identifier of the given multicast index
+ */
+#define LORAMAC_MC_NWK_S_KEY_ID( idx )              ( ( KeyIdentifier_t )( LORAMAC_MC_KEY_ID( idx ) + 2 ) )
+
+/*!
+ * Multicast downlink frame counter identifier of the given multicast index
+ */
+#define LORAMAC_MC_FCNT_DOWN_ID( idx )              ( ( FCntIdentifier_t )( ( ( idx ) < 4 ) ?                         \
+                                                      ( MC_FCNT_DOWN_0 + ( idx ) ) :                                  \
+                                                      ( MC_FCNT_DOWN_EXT + ( ( idx ) - 4 ) ) ) )
+
 /*
  * Multicast Rx window parameters
  */
@@ -599,6 +599,10 @@ typedef struct sRxConfigParams
      * Set to true, if RX should be continuous.
      */
     bool RxContinuous;
+    /*!
+     * LoRa preamble length [symbols].
+     */
+    uint16_t PreambleLength;
     /*!
      * Sets the RX window.
      */
@@ -641,6 +645,10 @@ typedef struct sTxConfigParams
      * Frame length to setup.
      */
     uint16_t PktLen;
+    /*!
+     * LoRa preamble length [symbols].
+     */
+    uint16_t PreambleLength;
 }TxConfigParams_t;
 
 /*!
@@ -802,6 +810,15 @@ typedef struct sNextChanParams
      * Payload length of the next frame
      */
     uint16_t PktLen;
+    /*!
+     * LoRa preamble length of the next frame [symbols].
+     */
+    uint16_t PreambleLength;
+    /*!
+     * Set to true, if the MAC performs the listen before talk with channel
+     * activity detection. The regions then skip the RSSI carrier sense.
+     */
+    bool LbtCadEnabled;
 }NextChanParams_t;
 
 /*!
@@ -119,7 +119,7 @@ static bool VerifyRfFreq( uint32_t freq )
     return true;
 }
 
-static TimerTime_t GetTimeOnAir( int8_t datarate, uint16_t pktLen )
+static TimerTime_t GetTimeOnAir( int8_t datarate, uint16_t pktLen, uint16_t preambleLen )
 {
     int8_t phyDr = DataratesAS923[datarate];
     uint32_t bandwidth = RegionCommonGetBandwidth( datarate, BandwidthsAS923 );
@@ -131,7 +131,7 @@ static TimerTime_t GetTimeOnAir( int8_t datarate, uint16_t pktLen )
     }
     else
     {
-        timeOnAir = Radio.TimeOnAir( MODEM_LORA, bandwidth, phyDr, 1, 8, false, pktLen, true );
+        timeOnAir = Radio.TimeOnAir( MODEM_LORA, bandwidth, phyDr, 1, preambleLen, false, pktLen, true );
     }
     return timeOnAir;
 }
@@ -604,7 +604,7 @@ bool RegionAS923RxConfig( RxConfigParams_t* rxConfig, int8_t* datarate )
     else
     {
         modem = MODEM_LORA;
-        Radio.SetRxConfig( modem, rxConfig->Bandwidth, phyDr, 1, 0, 8, rxConfig->WindowTimeout, false, 0, false, 0, 0, true, rxConfig->RxContinuous );
+        Radio.SetRxConfig( modem, rxConfig->Bandwidth, phyDr, 1, 0, rxConfig->PreambleLength, rxConfig->WindowTimeout, false, 0, false, 0, 0, true, rxConfig->RxContinuous );
     }
 
     Radio.SetMaxPayloadLength( modem, MaxPayloadOfDatarateDwell0AS923[dr] + LORAMAC_FRAME_PAYLOAD_OVERHEAD_SIZE );
@@ -635,11 +635,11 @@ bool RegionAS923TxConfig( TxConfigParams_t* txConfig, int8_t* txPower, TimerTime
     else
     {
         modem = MODEM_LORA;
-        Radio.SetTxConfig( modem, phyTxPower, 0, bandwidth, phyDr, 1, 8, false, true, 0, 0, false, 4000 );
+        Radio.SetTxConfig( modem, phyTxPower, 0, bandwidth, phyDr, 1, txConfig->PreambleLength, false, true, 0, 0, false, 4000 );
     }
 
     // Update time-on-air
-    *txTimeOnAir = GetTimeOnAir( txConfig->Datarate, txConfig->PktLen );
+    *txTimeOnAir = GetTimeOnAir( txConfig->Datarate, txConfig->PktLen, txConfig->PreambleLength );
 
     // Setup maximum payload lenght of the radio driver
     Radio.SetMaxPayloadLength( modem, txConfig->PktLen );
@@ -899,7 +899,7 @@ LoRaMacStatus_t RegionAS923NextChannel( NextChanParams_t* nextChanParams, uint8_
 
     identifyChannelsParam.ElapsedTimeSinceStartUp = nextChanParams->ElapsedTimeSinceStartUp;
     identifyChannelsParam.LastTxIsJoinRequest = nextChanParams->LastTxIsJoinRequest;
-    identifyChannelsParam.ExpectedTimeOnAir = GetTimeOnAir( nextChanParams->Datarate, nextChanParams->PktLen );
+    identifyChannelsParam.ExpectedTimeOnAir = GetTimeOnAir( nextChanParams->Datarate, nextChanParams->PktLen, nextChanParams->PreambleLength );
 
     identifyChannelsParam.CountNbOfEnabledChannelsParam = &countChannelsParams;
 
@@ -912,6 +912,13 @@ LoRaMacStatus_t RegionAS923NextChannel( NextChanParams_t* nextChanParams, uint8_
         // Executes the LBT algorithm when operating in Japan
         uint8_t channelNext = 0;
 
+        if( nextChanParams->LbtCadEnabled == true )
+        {
+            // The MAC performs the LBT with channel activity detection
+            *channel = enabledChannels[randr( 0, nbEnabledChannels - 1 )];
+            return LORAMAC_STATUS_OK;
+        }
+
         for( uint8_t  i = 0, j = randr( 0, nbEnabledChannels - 1 ); i < AS923_MAX_NB_CHANNELS; i++ )
         {
             channelNext = enabledChannels[j];
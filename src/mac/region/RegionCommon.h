@@ -99,6 +99,11 @@ extern "C"
  */
 #define REGION_COMMON_DEFAULT_DOWNLINK_DWELL_TIME       0
 
+/*!
+ * Default LoRa preamble length [symbols]
+ */
+#define REGION_COMMON_DEFAULT_PREAMBLE_LENGTH           8
+
 /*!
  * Default ping slots periodicity
  *
@@ -60,8 +60,10 @@ extern "C"
 #ifdef SOFT_SE
 /*!
  * Number of supported crypto keys for the soft-se
+ *
+ * \remark Multicast contexts 4 and above add 3 keys each
  */
-#define NUM_OF_KEYS             23
+#define NUM_OF_KEYS             ( 23 + ( ( LORAMAC_MAX_MC_CTX > 4 ) ? ( 3 * ( LORAMAC_MAX_MC_CTX - 4 ) ) : 0 ) )
 
 /*!
  * Key structure definition for the soft-se
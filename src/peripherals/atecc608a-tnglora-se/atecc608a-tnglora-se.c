@@ -364,7 +364,7 @@ SecureElementStatus_t SecureElementAesEncrypt( uint8_t* buffer, uint16_t size, K
 
     if( retval == SECURE_ELEMENT_SUCCESS )
     {
-        uint8_t block = 0;
+        uint16_t block = 0;
 
         while( size != 0 )
         {
@@ -63,6 +63,24 @@ static SecureElementStatus_t GetKeyByID( KeyIdentifier_t keyID, Key_t** keyItem
     return SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
 }
 
+/*
+ * Checks if the key identifier is a multicast root key
+ *
+ * \param[IN]  keyID          - Key identifier
+ * \retval                    - true if it is a multicast root key
+ */
+static bool IsMcRootKey( KeyIdentifier_t keyID )
+{
+    for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+    {
+        if( keyID == LORAMAC_MC_KEY_ID( i ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 /*
  * Computes a CMAC of a message using provided initial Bx block
  *
@@ -153,6 +171,16 @@ SecureElementStatus_t SecureElementInit( SecureElementNvmData_t* nvm )
     // Initialize data
     memcpy1( ( uint8_t* )SeNvm, ( uint8_t* )&seNvmInit, sizeof( seNvmInit ) );
 
+    // Multicast contexts 4 and above keys follow the SOFT_SE_KEY_LIST entries
+    for( uint8_t i = 4; i < LORAMAC_MAX_MC_CTX; i++ )
+    {
+        uint8_t keyIndex = NUM_OF_KEYS - ( 3 * ( LORAMAC_MAX_MC_CTX - i ) );
+
+        SeNvm->KeyList[keyIndex].KeyID = LORAMAC_MC_KEY_ID( i );
+        SeNvm->KeyList[keyIndex + 1].KeyID = LORAMAC_MC_APP_S_KEY_ID( i );
+        SeNvm->KeyList[keyIndex + 2].KeyID = LORAMAC_MC_NWK_S_KEY_ID( i );
+    }
+
 #if !defined( SECURE_ELEMENT_PRE_PROVISIONED )
 #if( STATIC_DEVICE_EUI == 0 )
     // Get a DevEUI from MCU unique ID
@@ -173,7 +201,7 @@ SecureElementStatus_t SecureElementSetKey( KeyIdentifier_t keyID, uint8_t* key )
     {
         if( SeNvm->KeyList[i].KeyID == keyID )
         {
-            if( ( keyID == MC_KEY_0 ) || ( keyID == MC_KEY_1 ) || ( keyID == MC_KEY_2 ) || ( keyID == MC_KEY_3 ) )
+            if( IsMcRootKey( keyID ) == true )
             {  // Decrypt the key if its a Mckey
                 SecureElementStatus_t retval           = SECURE_ELEMENT_ERROR;
                 uint8_t               decryptedKey[16] = { 0 };
@@ -254,7 +282,7 @@ SecureElementStatus_t SecureElementAesEncrypt( uint8_t* buffer, uint16_t size, K
     {
         aes_set_key( pItem->KeyValue, 16, &aesContext );
 
-        uint8_t block = 0;
+        uint16_t block = 0;
 
         while( size != 0 )
         {
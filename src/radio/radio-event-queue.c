@@ -0,0 +1,80 @@
+/*!
+ * \file      radio-event-queue.c
+ *
+ * \brief     Radio event queue implementation
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ */
+#include <stddef.h>
+#include "radio.h"
+
+#if ( ( RADIO_EVENT_QUEUE_SIZE & ( RADIO_EVENT_QUEUE_SIZE - 1 ) ) != 0 ) || ( RADIO_EVENT_QUEUE_SIZE > 128 )
+#error "RADIO_EVENT_QUEUE_SIZE must be a power of 2 lower than or equal to 128"
+#endif
+
+/*!
+ * Compiler barrier ordering the event copy and the index update
+ */
+#define RADIO_EVENT_QUEUE_BARRIER( )                __asm volatile( "" ::: "memory" )
+
+void RadioEventQueueInit( RadioEventQueue_t *queue )
+{
+    queue->Head = 0;
+    queue->Tail = 0;
+}
+
+bool RadioEventQueuePost( RadioEventQueue_t *queue, const RadioEvent_t *event )
+{
+    uint8_t head = queue->Head;
+    uint8_t index = head & ( RADIO_EVENT_QUEUE_SIZE - 1 );
+
+    // The indexes wrap around at 256, a multiple of the queue size
+    if( ( uint8_t )( head - queue->Tail ) >= RADIO_EVENT_QUEUE_SIZE )
+    {
+        return false;
+    }
+    queue->Events[index] = *event;
+    RADIO_EVENT_QUEUE_BARRIER( );
+    queue->Head = head + 1;
+    return true;
+}
+
+RadioEvent_t* RadioEventQueuePeek( RadioEventQueue_t *queue )
+{
+    uint8_t tail = queue->Tail;
+
+    if( tail == queue->Head )
+    {
+        return NULL;
+    }
+    RADIO_EVENT_QUEUE_BARRIER( );
+    return &queue->Events[tail & ( RADIO_EVENT_QUEUE_SIZE - 1 )];
+}
+
+void RadioEventQueueRemove( RadioEventQueue_t *queue )
+{
+    uint8_t tail = queue->Tail;
+
+    if( tail == queue->Head )
+    {
+        return;
+    }
+    RADIO_EVENT_QUEUE_BARRIER( );
+    queue->Tail = tail + 1;
+}
+
+bool RadioEventQueueIsEmpty( RadioEventQueue_t *queue )
+{
+    return queue->Tail == queue->Head;
+}
@@ -394,12 +394,34 @@ struct Radio_s
     /*!
      * \brief Sets the Rx duty cycle management parameters
      *
-     * \remark Available on SX126x radios only.
+     * \remark The radio listens for rxTime, then sleeps for sleepTime and so
+     *         on until a packet is received. Native on SX126x radios,
+     *         emulated by software for the LoRa modem on SX1272/SX1276 radios.
      *
-     * \param [in]  rxTime        Structure describing reception timeout value
-     * \param [in]  sleepTime     Structure describing sleep timeout value
+     * \param [in]  rxTime        Listen window duration [15.625 us steps]
+     * \param [in]  sleepTime     Sleep duration between listen windows [15.625 us steps]
      */
     void ( *SetRxDutyCycle ) ( uint32_t rxTime, uint32_t sleepTime );
+    /*!
+     * \brief Sets the channel activity detection duration used by StartCad
+     *
+     * \remark Native on SX126x radios, where the number of symbols is rounded
+     *         down to a supported value. Emulated by chaining CAD operations
+     *         on SX1272/SX1276 radios.
+     *
+     * \param [in]  symbols       Number of symbols to listen for [1, 2, 4, 8, 16]
+     */
+    void ( *SetCadParams )( uint8_t symbols );
+    /*!
+     * \brief Gets the time of the last radio interrupt
+     *
+     * \remark Captured in the DIO and timeout interrupt handlers, before the
+     *         events are processed. Allows to time the reception windows from
+     *         the actual TxDone instant.
+     *
+     * \retval time Time of the last radio interrupt [ms], TimerGetCurrentTime base
+     */
+    uint32_t ( *GetIrqTime )( void );
 };
 
 /*!
@@ -410,6 +432,138 @@ struct Radio_s
  */
 extern const struct Radio_s Radio;
 
+/*!
+ * Radio event queue size. Must be a power of 2
+ */
+#ifndef RADIO_EVENT_QUEUE_SIZE
+#define RADIO_EVENT_QUEUE_SIZE                      8
+#endif
+
+/*!
+ * Radio event types
+ */
+typedef enum
+{
+    RADIO_EVENT_TX_DONE = 0,
+    RADIO_EVENT_TX_TIMEOUT,
+    RADIO_EVENT_RX_DONE,
+    RADIO_EVENT_RX_TIMEOUT,
+    RADIO_EVENT_RX_ERROR,
+    RADIO_EVENT_CAD_DONE,
+}RadioEventType_t;
+
+/*!
+ * Radio event
+ */
+typedef struct sRadioEvent
+{
+    /*!
+     * Event type
+     */
+    RadioEventType_t Type;
+    /*!
+     * Time of the radio interrupt [ms], TimerGetCurrentTime base
+     */
+    uint32_t Time;
+    /*!
+     * RADIO_EVENT_RX_DONE: received buffer. Points to the radio driver buffer,
+     * which is overwritten by the next reception
+     */
+    uint8_t *Payload;
+    /*!
+     * RADIO_EVENT_RX_DONE: received buffer size
+     */
+    uint16_t Size;
+    /*!
+     * RADIO_EVENT_RX_DONE: RSSI value computed while receiving the frame [dBm]
+     */
+    int16_t Rssi;
+    /*!
+     * RADIO_EVENT_RX_DONE: SNR value computed while receiving the frame [dB]
+     */
+    int8_t Snr;
+    /*!
+     * RADIO_EVENT_CAD_DONE: channel activity detected
+     */
+    bool ChannelActivityDetected;
+}RadioEvent_t;
+
+/*!
+ * Single producer, single consumer radio event queue
+ *
+ * The producer posts the events from the radio callbacks, the consumer
+ * processes them in order from the main loop. Back-to-back events are kept
+ * apart and none is lost as long as the queue does not overflow.
+ *
+ * \remark The received payloads are not copied. The consumer must not
+ *         restart the reception before it is done with the payload of a
+ *         RADIO_EVENT_RX_DONE event.
+ *
+ * \remark The consumer side needs no lock. Radio callbacks running in
+ *         interrupts that may preempt each other must serialize their posts,
+ *         e.g. with a critical section.
+ */
+typedef struct sRadioEventQueue
+{
+    /*!
+     * Events storage
+     */
+    RadioEvent_t Events[RADIO_EVENT_QUEUE_SIZE];
+    /*!
+     * Number of events posted. Only written by the producer
+     */
+    volatile uint8_t Head;
+    /*!
+     * Number of events removed. Only written by the consumer
+     */
+    volatile uint8_t Tail;
+}RadioEventQueue_t;
+
+/*!
+ * \brief Initializes the radio event queue
+ *
+ * \param [IN] queue Pointer to the queue
+ */
+void RadioEventQueueInit( RadioEventQueue_t *queue );
+
+/*!
+ * \brief Posts an event to the queue. Producer side
+ *
+ * \param [IN] queue Pointer to the queue
+ * \param [IN] event Event to be copied into the queue
+ *
+ * \retval status [true: posted, false: queue full, event dropped]
+ */
+bool RadioEventQueuePost( RadioEventQueue_t *queue, const RadioEvent_t *event );
+
+/*!
+ * \brief Gets the oldest event of the queue. Consumer side
+ *
+ * \remark The event remains valid until \ref RadioEventQueueRemove is
+ *         called
+ *
+ * \param [IN] queue Pointer to the queue
+ *
+ * \retval event  Oldest event. NULL if the queue is empty
+ */
+RadioEvent_t* RadioEventQueuePeek( RadioEventQueue_t *queue );
+
+/*!
+ * \brief Removes the oldest event of the queue. Consumer side
+ *
+ * \param [IN] queue Pointer to the queue
+ */
+void RadioEventQueueRemove( RadioEventQueue_t *queue );
+
+/*!
+ * \brief Checks if the queue is empty
+ *
+ * \param [IN] queue Pointer to the queue
+ *
+ * \retval isEmpty [true: empty, false: at least one event pending]
+ */
+bool RadioEventQueueIsEmpty( RadioEventQueue_t *queue );
+
 #ifdef __cplusplus
 }
 #endif
@@ -336,6 +336,20 @@ void RadioRxBoosted( uint32_t timeout );
  */
 void RadioSetRxDutyCycle( uint32_t rxTime, uint32_t sleepTime );
 
+/*!
+ * \brief Sets the channel activity detection duration
+ *
+ * \param [in]  symbols       Number of symbols to listen for [1, 2, 4, 8, 16]
+ */
+void RadioSetCadParams( uint8_t symbols );
+
+/*!
+ * \brief Gets the time of the last radio interrupt
+ *
+ * \retval time Time captured in the DIO and timeout interrupt handlers [ms]
+ */
+uint32_t RadioGetIrqTime( void );
+
 /*!
  * \brief Add a register to the retention list
  *
@@ -375,7 +389,9 @@ const struct Radio_s Radio =
     RadioIrqProcess,
     // Available on SX126x only
     RadioRxBoosted,
-    RadioSetRxDutyCycle
+    RadioSetRxDutyCycle,
+    RadioSetCadParams,
+    RadioGetIrqTime
 };
 
 /*
@@ -434,6 +450,11 @@ bool RxContinuous = false;
 PacketStatus_t RadioPktStatus;
 uint8_t RadioRxPayload[255];
 
+/*!
+ * Set by the DIO1 interrupt, cleared by RadioIrqProcess. The IRQ status and
+ * the payload are read over SPI, which waits on the BUSY line, hence out of
+ * the interrupt. The radio events are posted from RadioIrqProcess
+ */
 bool IrqFired = false;
 
 /*
@@ -476,6 +497,30 @@ static RadioPublicNetwork_t RadioPublicNetwork = { false };
  */
 static RadioEvents_t* RadioEvents;
 
+/*!
+ * Last values written to the IQ polarity and Tx modulation registers.
+ * Both registers are part of the retention list. -1 when unknown.
+ */
+static int16_t RegIqPolarityShadow = -1;
+static int16_t RegTxModulationShadow = -1;
+
+/*!
+ * Number of symbols used by the channel activity detection
+ */
+static RadioLoRaCadSymbols_t RadioCadSymbols = LORA_CAD_02_SYMBOL;
+
+/*!
+ * CAD detection peak recommended for each spreading factor, SF5 to SF12.
+ * The detection minimum is 10 for all of them. See application note AN1200.48
+ */
+static const uint8_t RadioCadDetPeaks[] = { 22, 22, 22, 22, 23, 24, 25, 28 };
+
+/*!
+ * Time of the last radio interrupt [ms]. The events are processed later by
+ * RadioIrqProcess, the time is captured in the interrupt handlers.
+ */
+static uint32_t RadioIrqTime = 0;
+
 /*
  * Public global variables
  */
@@ -517,6 +562,48 @@ static uint8_t RadioGetFskBandwidthRegValue( uint32_t bandwidth )
     while( 1 );
 }
 
+/*!
+ * Sets the masked bits of a register. The SPI accesses are skipped when the
+ * shadowed register value already holds the requested bits.
+ *
+ * \param [IN] address Register address
+ * \param [IN/OUT] shadow Last value written to the register, -1 when unknown
+ * \param [IN] mask Bits to update
+ * \param [IN] value New value of the masked bits
+ */
+static void RadioUpdateRegisterBits( uint16_t address, int16_t* shadow, uint8_t mask, uint8_t value )
+{
+    uint8_t regValue;
+    uint8_t newValue;
+
+    if( *shadow < 0 )
+    {
+        regValue = SX126xReadRegister( address );
+    }
+    else
+    {
+        regValue = ( uint8_t )*shadow;
+    }
+    newValue = ( regValue & ~mask ) | ( value & mask );
+
+    if( ( *shadow < 0 ) || ( newValue != regValue ) )
+    {
+        SX126xWriteRegister( address, newValue );
+    }
+    *shadow = newValue;
+}
+
+/*!
+ * Puts the radio in standby mode unless it already is in RC standby
+ */
+static void RadioStandbyIfNeeded( void )
+{
+    if( SX126xGetOperatingMode( ) != MODE_STDBY_RC )
+    {
+        RadioStandby( );
+    }
+}
+
 void RadioInit( RadioEvents_t *events )
 {
     RadioEvents = events;
@@ -532,6 +619,9 @@ void RadioInit( RadioEvents_t *events )
     // Add registers to the retention list (4 is the maximum possible number)
     RadioAddRegisterToRetentionList( REG_RX_GAIN );
     RadioAddRegisterToRetentionList( REG_TX_MODULATION );
+    RadioAddRegisterToRetentionList( REG_IQ_POLARITY );
+    RegIqPolarityShadow = -1;
+    RegTxModulationShadow = -1;
 
     // Initialize driver timeout timers
     TimerInit( &TxTimeoutTimer, RadioOnTxTimeoutIrq );
@@ -547,6 +637,7 @@ RadioState_t RadioGetStatus( void )
         case MODE_TX:
             return RF_TX_RUNNING;
         case MODE_RX:
+        case MODE_RX_DC:
             return RF_RX_RUNNING;
         case MODE_CAD:
             return RF_CAD;
@@ -685,7 +776,7 @@ void RadioSetRxConfig( RadioModems_t modem, uint32_t bandwidth,
             }
             SX126x.PacketParams.Params.Gfsk.DcFree = RADIO_DC_FREEWHITENING;
 
-            RadioStandby( );
+            RadioStandbyIfNeeded( );
             RadioSetModem( ( SX126x.ModulationParams.PacketType == PACKET_TYPE_GFSK ) ? MODEM_FSK : MODEM_LORA );
             SX126xSetModulationParams( &SX126x.ModulationParams );
             SX126xSetPacketParams( &SX126x.PacketParams );
@@ -737,7 +828,7 @@ void RadioSetRxConfig( RadioModems_t modem, uint32_t bandwidth,
             SX126x.PacketParams.Params.LoRa.CrcMode = ( RadioLoRaCrcModes_t )crcOn;
             SX126x.PacketParams.Params.LoRa.InvertIQ = ( RadioLoRaIQModes_t )iqInverted;
 
-            RadioStandby( );
+            RadioStandbyIfNeeded( );
             RadioSetModem( ( SX126x.ModulationParams.PacketType == PACKET_TYPE_GFSK ) ? MODEM_FSK : MODEM_LORA );
             SX126xSetModulationParams( &SX126x.ModulationParams );
             SX126xSetPacketParams( &SX126x.PacketParams );
@@ -746,11 +837,11 @@ void RadioSetRxConfig( RadioModems_t modem, uint32_t bandwidth,
             // WORKAROUND - Optimizing the Inverted IQ Operation, see DS_SX1261-2_V1.2 datasheet chapter 15.4
             if( SX126x.PacketParams.Params.LoRa.InvertIQ == LORA_IQ_INVERTED )
             {
-                SX126xWriteRegister( REG_IQ_POLARITY, SX126xReadRegister( REG_IQ_POLARITY ) & ~( 1 << 2 ) );
+                RadioUpdateRegisterBits( REG_IQ_POLARITY, &RegIqPolarityShadow, ( 1 << 2 ), 0 );
             }
             else
             {
-                SX126xWriteRegister( REG_IQ_POLARITY, SX126xReadRegister( REG_IQ_POLARITY ) | ( 1 << 2 ) );
+                RadioUpdateRegisterBits( REG_IQ_POLARITY, &RegIqPolarityShadow, ( 1 << 2 ), ( 1 << 2 ) );
             }
             // WORKAROUND END
 
@@ -795,7 +886,7 @@ void RadioSetTxConfig( RadioModems_t modem, int8_t power, uint32_t fdev,
             }
             SX126x.PacketParams.Params.Gfsk.DcFree = RADIO_DC_FREEWHITENING;
 
-            RadioStandby( );
+            RadioStandbyIfNeeded( );
             RadioSetModem( ( SX126x.ModulationParams.PacketType == PACKET_TYPE_GFSK ) ? MODEM_FSK : MODEM_LORA );
             SX126xSetModulationParams( &SX126x.ModulationParams );
             SX126xSetPacketParams( &SX126x.PacketParams );
@@ -843,7 +934,7 @@ void RadioSetTxConfig( RadioModems_t modem, int8_t power, uint32_t fdev,
             SX126x.PacketParams.Params.LoRa.CrcMode = ( RadioLoRaCrcModes_t )crcOn;
             SX126x.PacketParams.Params.LoRa.InvertIQ = ( RadioLoRaIQModes_t )iqInverted;
 
-            RadioStandby( );
+            RadioStandbyIfNeeded( );
             RadioSetModem( ( SX126x.ModulationParams.PacketType == PACKET_TYPE_GFSK ) ? MODEM_FSK : MODEM_LORA );
             SX126xSetModulationParams( &SX126x.ModulationParams );
             SX126xSetPacketParams( &SX126x.PacketParams );
@@ -853,11 +944,11 @@ void RadioSetTxConfig( RadioModems_t modem, int8_t power, uint32_t fdev,
     // WORKAROUND - Modulation Quality with 500 kHz LoRa Bandwidth, see DS_SX1261-2_V1.2 datasheet chapter 15.1
     if( ( modem == MODEM_LORA ) && ( SX126x.ModulationParams.Params.LoRa.Bandwidth == LORA_BW_500 ) )
     {
-        SX126xWriteRegister( REG_TX_MODULATION, SX126xReadRegister( REG_TX_MODULATION ) & ~( 1 << 2 ) );
+        RadioUpdateRegisterBits( REG_TX_MODULATION, &RegTxModulationShadow, ( 1 << 2 ), 0 );
     }
     else
     {
-        SX126xWriteRegister( REG_TX_MODULATION, SX126xReadRegister( REG_TX_MODULATION ) | ( 1 << 2 ) );
+        RadioUpdateRegisterBits( REG_TX_MODULATION, &RegTxModulationShadow, ( 1 << 2 ), ( 1 << 2 ) );
     }
     // WORKAROUND END
 
@@ -1109,6 +1200,11 @@ void RadioRxBoosted( uint32_t timeout )
 
 void RadioSetRxDutyCycle( uint32_t rxTime, uint32_t sleepTime )
 {
+    SX126xSetDioIrqParams( IRQ_RADIO_ALL, //IRQ_RX_DONE | IRQ_RX_TX_TIMEOUT,
+                           IRQ_RADIO_ALL, //IRQ_RX_DONE | IRQ_RX_TX_TIMEOUT,
+                           IRQ_RADIO_NONE,
+                           IRQ_RADIO_NONE );
+
     SX126xSetRxDutyCycle( rxTime, sleepTime );
 }
 
@@ -1142,8 +1238,39 @@ void RadioAddRegisterToRetentionList( uint16_t registerAddress )
     }
 }
 
+void RadioSetCadParams( uint8_t symbols )
+{
+    if( symbols >= 16 )
+    {
+        RadioCadSymbols = LORA_CAD_16_SYMBOL;
+    }
+    else if( symbols >= 8 )
+    {
+        RadioCadSymbols = LORA_CAD_08_SYMBOL;
+    }
+    else if( symbols >= 4 )
+    {
+        RadioCadSymbols = LORA_CAD_04_SYMBOL;
+    }
+    else if( symbols >= 2 )
+    {
+        RadioCadSymbols = LORA_CAD_02_SYMBOL;
+    }
+    else
+    {
+        RadioCadSymbols = LORA_CAD_01_SYMBOL;
+    }
+}
+
 void RadioStartCad( void )
 {
+    uint8_t sfIndex = ( uint8_t )SX126x.ModulationParams.Params.LoRa.SpreadingFactor - LORA_SF5;
+
+    if( sfIndex >= sizeof( RadioCadDetPeaks ) )
+    {
+        sfIndex = sizeof( RadioCadDetPeaks ) - 1;
+    }
+    SX126xSetCadParams( RadioCadSymbols, RadioCadDetPeaks[sfIndex], 10, LORA_CAD_ONLY, 0 );
     SX126xSetDioIrqParams( IRQ_CAD_DONE | IRQ_CAD_ACTIVITY_DETECTED, IRQ_CAD_DONE | IRQ_CAD_ACTIVITY_DETECTED, IRQ_RADIO_NONE, IRQ_RADIO_NONE );
     SX126xSetCad( );
 }
@@ -1226,8 +1353,15 @@ uint32_t RadioGetWakeupTime( void )
     return SX126xGetBoardTcxoWakeupTime( ) + RADIO_WAKEUP_TIME;
 }
 
+uint32_t RadioGetIrqTime( void )
+{
+    return RadioIrqTime;
+}
+
 void RadioOnTxTimeoutIrq( void* context )
 {
+    RadioIrqTime = TimerGetCurrentTime( );
+
     if( ( RadioEvents != NULL ) && ( RadioEvents->TxTimeout != NULL ) )
     {
         RadioEvents->TxTimeout( );
@@ -1236,6 +1370,8 @@ void RadioOnTxTimeoutIrq( void* context )
 
 void RadioOnRxTimeoutIrq( void* context )
 {
+    RadioIrqTime = TimerGetCurrentTime( );
+
     if( ( RadioEvents != NULL ) && ( RadioEvents->RxTimeout != NULL ) )
     {
         RadioEvents->RxTimeout( );
@@ -1244,6 +1380,7 @@ void RadioOnRxTimeoutIrq( void* context )
 
 void RadioOnDioIrq( void* context )
 {
+    RadioIrqTime = TimerGetCurrentTime( );
     IrqFired = true;
 }
 
@@ -1285,7 +1422,8 @@ void RadioIrqProcess( void )
 
             if( ( irqRegs & IRQ_CRC_ERROR ) == IRQ_CRC_ERROR )
             {
-                if( RxContinuous == false )
+                // The radio leaves the Rx duty cycle mode once a packet is received
+                if( ( RxContinuous == false ) || ( SX126xGetOperatingMode( ) == MODE_RX_DC ) )
                 {
                     //!< Update operating mode state to a value lower than \ref MODE_STDBY_XOSC
                     SX126xSetOperatingMode( MODE_STDBY_RC );
@@ -1299,7 +1437,7 @@ void RadioIrqProcess( void )
             {
                 uint8_t size;
 
-                if( RxContinuous == false )
+                if( ( RxContinuous == false ) || ( SX126xGetOperatingMode( ) == MODE_RX_DC ) )
                 {
                     //!< Update operating mode state to a value lower than \ref MODE_STDBY_XOSC
                     SX126xSetOperatingMode( MODE_STDBY_RC );
@@ -1370,7 +1508,7 @@ void RadioIrqProcess( void )
         if( ( irqRegs & IRQ_HEADER_ERROR ) == IRQ_HEADER_ERROR )
         {
             TimerStop( &RxTimeoutTimer );
-            if( RxContinuous == false )
+            if( ( RxContinuous == false ) || ( SX126xGetOperatingMode( ) == MODE_RX_DC ) )
             {
                 //!< Update operating mode state to a value lower than \ref MODE_STDBY_XOSC
                 SX126xSetOperatingMode( MODE_STDBY_RC );
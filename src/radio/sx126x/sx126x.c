@@ -48,6 +48,20 @@
  */
 #define SX126X_MAX_LORA_SYMB_NUM_TIMEOUT            248
 
+/*!
+ * \brief Number of entries of the frequency to PLL steps conversion cache
+ *
+ * \remark Must be a power of 2
+ */
+#ifndef SX126X_PLL_STEP_CACHE_SIZE
+#define SX126X_PLL_STEP_CACHE_SIZE                  16
+#endif
+
+/*!
+ * \brief Marks the image calibration as to be done on next frequency change
+ */
+#define SX126X_IMAGE_CALIBRATION_BAND_NONE          0xFF
+
 /*!
  * \brief Radio registers definition
  */
@@ -73,9 +87,76 @@ static volatile RadioLoRaPacketLengthsMode_t LoRaHeaderType;
 volatile uint32_t FrequencyError = 0;
 
 /*!
- * \brief Hold the status of the Image calibration
+ * \brief Image calibration band descriptor
+ */
+typedef struct SX126xImageCalibrationBand_s
+{
+    uint32_t FreqMin;                               //!< Band applies to frequencies above this value [Hz]
+    uint8_t  CalFreq[2];                            //!< RADIO_CALIBRATEIMAGE parameters
+}SX126xImageCalibrationBand_t;
+
+/*!
+ * \brief Image calibration bands, ordered by decreasing frequency
+ */
+static const SX126xImageCalibrationBand_t ImageCalibrationBands[] =
+{
+    { 900000000, { 0xE1, 0xE9 } },
+    { 850000000, { 0xD7, 0xDB } },
+    { 770000000, { 0xC1, 0xC5 } },
+    { 460000000, { 0x75, 0x81 } },
+    {         0, { 0x6B, 0x6F } },
+};
+
+/*!
+ * \brief Index in ImageCalibrationBands of the last image calibration run
+ *        or SX126X_IMAGE_CALIBRATION_BAND_NONE
+ */
+static uint8_t ImageCalibrationBand = SX126X_IMAGE_CALIBRATION_BAND_NONE;
+
+/*!
+ * \brief Frequency to PLL steps conversion cache entry
+ *
+ * \remark A zeroed entry is valid as 0 Hz converts to 0 PLL steps
+ */
+typedef struct SX126xPllStepCacheEntry_s
+{
+    uint32_t FreqInHz;
+    uint32_t PllSteps;
+}SX126xPllStepCacheEntry_t;
+
+/*!
+ * \brief Direct-mapped cache of the last converted frequencies
+ */
+static SX126xPllStepCacheEntry_t PllStepCache[SX126X_PLL_STEP_CACHE_SIZE];
+
+/*!
+ * \brief Last configuration written to the radio
+ *
+ * \remark Used to skip commands and register writes whose content is already
+ *         applied. The radio retains this configuration in warm start sleep.
+ *         A size or valid field at 0 marks an unknown radio configuration.
+ */
+typedef struct sSX126xParamsShadow
+{
+    bool     PacketTypeValid;
+    uint8_t  ModulationParams[8];
+    uint8_t  ModulationParamsSize;
+    uint8_t  PacketParams[9];
+    uint8_t  PacketParamsSize;
+    uint8_t  SyncWord[8];
+    bool     SyncWordValid;
+    uint16_t WhiteningSeed;
+    bool     WhiteningSeedValid;
+    bool     StopRxTimerOnPreambleDetect;
+    bool     StopRxTimerOnPreambleDetectValid;
+}SX126xParamsShadow_t;
+
+static SX126xParamsShadow_t ParamsShadow;
+
+/*!
+ * \brief Invalidates the whole configuration shadow
  */
-static bool ImageCalibrated = false;
+static void SX126xResetParamsShadow( void );
 
 /*!
  * \brief Get the number of PLL steps for a given frequency in Hertz
@@ -86,6 +167,15 @@ static bool ImageCalibrated = false;
  */
 static uint32_t SX126xConvertFreqInHzToPllStep( uint32_t freqInHz );
 
+/*!
+ * \brief Get the image calibration band of a given frequency
+ *
+ * \param [in] freq Frequency in Hertz
+ *
+ * \returns Index in ImageCalibrationBands
+ */
+static uint8_t SX126xGetImageCalibrationBand( uint32_t freq );
+
 /*
  * SX126x DIO IRQ callback functions prototype
  */
@@ -126,7 +216,9 @@ void SX126xInit( DioIrqHandler dioIrq )
     SX126xIoRfSwitchInit( );
 
     // Force image calibration
-    ImageCalibrated = false;
+    ImageCalibrationBand = SX126X_IMAGE_CALIBRATION_BAND_NONE;
+
+    SX126xResetParamsShadow( );
 
     SX126xSetOperatingMode( MODE_STDBY_RC );
 }
@@ -168,7 +260,14 @@ void SX126xSendPayload( uint8_t *payload, uint8_t size, uint32_t timeout )
 
 uint8_t SX126xSetSyncWord( uint8_t *syncWord )
 {
+    if( ( ParamsShadow.SyncWordValid == true ) &&
+        ( memcmp( ParamsShadow.SyncWord, syncWord, 8 ) == 0 ) )
+    {
+        return 0;
+    }
     SX126xWriteRegisters( REG_LR_SYNCWORDBASEADDRESS, syncWord, 8 );
+    memcpy1( ParamsShadow.SyncWord, syncWord, 8 );
+    ParamsShadow.SyncWordValid = true;
     return 0;
 }
 
@@ -215,6 +314,13 @@ void SX126xSetWhiteningSeed( uint16_t seed )
     switch( SX126xGetPacketType( ) )
     {
         case PACKET_TYPE_GFSK:
+            if( ( ParamsShadow.WhiteningSeedValid == true ) && ( ParamsShadow.WhiteningSeed == seed ) )
+            {
+                break;
+            }
+            ParamsShadow.WhiteningSeed = seed;
+            ParamsShadow.WhiteningSeedValid = true;
+
             regValue = SX126xReadRegister( REG_LR_WHITSEEDBASEADDR_MSB ) & 0xFE;
             regValue = ( ( seed >> 8 ) & 0x01 ) | regValue;
             SX126xWriteRegister( REG_LR_WHITSEEDBASEADDR_MSB, regValue ); // only 1 bit.
@@ -262,7 +368,9 @@ void SX126xSetSleep( SleepParams_t sleepConfig )
     if( sleepConfig.Fields.WarmStart == 0 )
     {
         // Force image calibration
-        ImageCalibrated = false;
+        ImageCalibrationBand = SX126X_IMAGE_CALIBRATION_BAND_NONE;
+        // Configuration is lost
+        SX126xResetParamsShadow( );
     }
     SX126xWriteCommand( RADIO_SET_SLEEP, &value, 1 );
     SX126xSetOperatingMode( MODE_SLEEP );
@@ -361,7 +469,14 @@ void SX126xSetTxInfinitePreamble( void )
 
 void SX126xSetStopRxTimerOnPreambleDetect( bool enable )
 {
+    if( ( ParamsShadow.StopRxTimerOnPreambleDetectValid == true ) &&
+        ( ParamsShadow.StopRxTimerOnPreambleDetect == enable ) )
+    {
+        return;
+    }
     SX126xWriteCommand( RADIO_SET_STOPRXTIMERONPREAMBLE, ( uint8_t* )&enable, 1 );
+    ParamsShadow.StopRxTimerOnPreambleDetect = enable;
+    ParamsShadow.StopRxTimerOnPreambleDetectValid = true;
 }
 
 void SX126xSetLoRaSymbNumTimeout( uint8_t symbNum )
@@ -408,34 +523,14 @@ void SX126xCalibrate( CalibrationParams_t calibParam )
 
 void SX126xCalibrateImage( uint32_t freq )
 {
+    uint8_t band = SX126xGetImageCalibrationBand( freq );
     uint8_t calFreq[2];
 
-    if( freq > 900000000 )
-    {
-        calFreq[0] = 0xE1;
-        calFreq[1] = 0xE9;
-    }
-    else if( freq > 850000000 )
-    {
-        calFreq[0] = 0xD7;
-        calFreq[1] = 0xDB;
-    }
-    else if( freq > 770000000 )
-    {
-        calFreq[0] = 0xC1;
-        calFreq[1] = 0xC5;
-    }
-    else if( freq > 460000000 )
-    {
-        calFreq[0] = 0x75;
-        calFreq[1] = 0x81;
-    }
-    else if( freq > 425000000 )
-    {
-        calFreq[0] = 0x6B;
-        calFreq[1] = 0x6F;
-    }
+    calFreq[0] = ImageCalibrationBands[band].CalFreq[0];
+    calFreq[1] = ImageCalibrationBands[band].CalFreq[1];
     SX126xWriteCommand( RADIO_CALIBRATEIMAGE, calFreq, 2 );
+
+    ImageCalibrationBand = band;
 }
 
 void SX126xSetPaConfig( uint8_t paDutyCycle, uint8_t hpMax, uint8_t deviceSel, uint8_t paLut )
@@ -498,10 +593,10 @@ void SX126xSetRfFrequency( uint32_t frequency )
 {
     uint8_t buf[4];
 
-    if( ImageCalibrated == false )
+    // Image calibration only needs to be run again when crossing a calibration band
+    if( SX126xGetImageCalibrationBand( frequency ) != ImageCalibrationBand )
     {
         SX126xCalibrateImage( frequency );
-        ImageCalibrated = true;
     }
 
     uint32_t freqInPllSteps = SX126xConvertFreqInHzToPllStep( frequency );
@@ -515,9 +610,17 @@ void SX126xSetRfFrequency( uint32_t frequency )
 
 void SX126xSetPacketType( RadioPacketTypes_t packetType )
 {
+    if( ( ParamsShadow.PacketTypeValid == true ) && ( PacketType == packetType ) )
+    {
+        return;
+    }
     // Save packet type internally to avoid questioning the radio
     PacketType = packetType;
     SX126xWriteCommand( RADIO_SET_PACKETTYPE, ( uint8_t* )&packetType, 1 );
+
+    // Packet type change resets the modem parameters
+    SX126xResetParamsShadow( );
+    ParamsShadow.PacketTypeValid = true;
 }
 
 RadioPacketTypes_t SX126xGetPacketType( void )
@@ -596,7 +699,6 @@ void SX126xSetModulationParams( ModulationParams_t *modulationParams )
         buf[5] = ( tempVal >> 16 ) & 0xFF;
         buf[6] = ( tempVal >> 8 ) & 0xFF;
         buf[7] = ( tempVal& 0xFF );
-        SX126xWriteCommand( RADIO_SET_MODULATIONPARAMS, buf, n );
         break;
     case PACKET_TYPE_LORA:
         n = 4;
@@ -604,14 +706,20 @@ void SX126xSetModulationParams( ModulationParams_t *modulationParams )
         buf[1] = modulationParams->Params.LoRa.Bandwidth;
         buf[2] = modulationParams->Params.LoRa.CodingRate;
         buf[3] = modulationParams->Params.LoRa.LowDatarateOptimize;
-
-        SX126xWriteCommand( RADIO_SET_MODULATIONPARAMS, buf, n );
-
         break;
     default:
     case PACKET_TYPE_NONE:
         return;
     }
+
+    if( ( ParamsShadow.ModulationParamsSize == n ) &&
+        ( memcmp( ParamsShadow.ModulationParams, buf, n ) == 0 ) )
+    {
+        return;
+    }
+    SX126xWriteCommand( RADIO_SET_MODULATIONPARAMS, buf, n );
+    memcpy1( ParamsShadow.ModulationParams, buf, n );
+    ParamsShadow.ModulationParamsSize = n;
 }
 
 void SX126xSetPacketParams( PacketParams_t *packetParams )
@@ -632,14 +740,10 @@ void SX126xSetPacketParams( PacketParams_t *packetParams )
     case PACKET_TYPE_GFSK:
         if( packetParams->Params.Gfsk.CrcLength == RADIO_CRC_2_BYTES_IBM )
         {
-            SX126xSetCrcSeed( CRC_IBM_SEED );
-            SX126xSetCrcPolynomial( CRC_POLYNOMIAL_IBM );
             crcVal = RADIO_CRC_2_BYTES;
         }
         else if( packetParams->Params.Gfsk.CrcLength == RADIO_CRC_2_BYTES_CCIT )
         {
-            SX126xSetCrcSeed( CRC_CCITT_SEED );
-            SX126xSetCrcPolynomial( CRC_POLYNOMIAL_CCITT );
             crcVal = RADIO_CRC_2_BYTES_INV;
         }
         else
@@ -670,7 +774,29 @@ void SX126xSetPacketParams( PacketParams_t *packetParams )
     case PACKET_TYPE_NONE:
         return;
     }
+
+    if( ( ParamsShadow.PacketParamsSize == n ) &&
+        ( memcmp( ParamsShadow.PacketParams, buf, n ) == 0 ) )
+    {
+        return;
+    }
+
+    if( packetParams->PacketType == PACKET_TYPE_GFSK )
+    {
+        if( packetParams->Params.Gfsk.CrcLength == RADIO_CRC_2_BYTES_IBM )
+        {
+            SX126xSetCrcSeed( CRC_IBM_SEED );
+            SX126xSetCrcPolynomial( CRC_POLYNOMIAL_IBM );
+        }
+        else if( packetParams->Params.Gfsk.CrcLength == RADIO_CRC_2_BYTES_CCIT )
+        {
+            SX126xSetCrcSeed( CRC_CCITT_SEED );
+            SX126xSetCrcPolynomial( CRC_POLYNOMIAL_CCITT );
+        }
+    }
     SX126xWriteCommand( RADIO_SET_PACKETPARAMS, buf, n );
+    memcpy1( ParamsShadow.PacketParams, buf, n );
+    ParamsShadow.PacketParamsSize = n;
 }
 
 void SX126xSetCadParams( RadioLoRaCadSymbols_t cadSymbolNum, uint8_t cadDetPeak, uint8_t cadDetMin, RadioCadExitModes_t cadExitMode, uint32_t cadTimeout )
@@ -803,18 +929,45 @@ void SX126xClearIrqStatus( uint16_t irq )
     SX126xWriteCommand( RADIO_CLR_IRQSTATUS, buf, 2 );
 }
 
+static void SX126xResetParamsShadow( void )
+{
+    memset1( ( uint8_t* )&ParamsShadow, 0, sizeof( SX126xParamsShadow_t ) );
+}
+
+static uint8_t SX126xGetImageCalibrationBand( uint32_t freq )
+{
+    uint8_t band = 0;
+    const uint8_t lastBand = ( sizeof( ImageCalibrationBands ) / sizeof( ImageCalibrationBands[0] ) ) - 1;
+
+    while( ( band < lastBand ) && ( freq <= ImageCalibrationBands[band].FreqMin ) )
+    {
+        band++;
+    }
+    return band;
+}
+
 static uint32_t SX126xConvertFreqInHzToPllStep( uint32_t freqInHz )
 {
+    // Channel plans use a small set of frequencies. Index on 16 kHz granularity
+    // so that adjacent channels land in different entries.
+    SX126xPllStepCacheEntry_t *entry = &PllStepCache[( freqInHz >> 14 ) & ( SX126X_PLL_STEP_CACHE_SIZE - 1 )];
     uint32_t stepsInt;
     uint32_t stepsFrac;
 
+    if( entry->FreqInHz == freqInHz )
+    {
+        return entry->PllSteps;
+    }
+
     // pllSteps = freqInHz / (SX126X_XTAL_FREQ / 2^19 )
     // Get integer and fractional parts of the frequency computed with a PLL step scaled value
     stepsInt = freqInHz / SX126X_PLL_STEP_SCALED;
     stepsFrac = freqInHz - ( stepsInt * SX126X_PLL_STEP_SCALED );
     
     // Apply the scaling factor to retrieve a frequency in Hz (+ ceiling)
-    return ( stepsInt << SX126X_PLL_STEP_SHIFT_AMOUNT ) + 
-           ( ( ( stepsFrac << SX126X_PLL_STEP_SHIFT_AMOUNT ) + ( SX126X_PLL_STEP_SCALED >> 1 ) ) /
-             SX126X_PLL_STEP_SCALED );
+    entry->FreqInHz = freqInHz;
+    entry->PllSteps = ( stepsInt << SX126X_PLL_STEP_SHIFT_AMOUNT ) + 
+                      ( ( ( stepsFrac << SX126X_PLL_STEP_SHIFT_AMOUNT ) + ( SX126X_PLL_STEP_SCALED >> 1 ) ) /
+                        SX126X_PLL_STEP_SCALED );
+    return entry->PllSteps;
 }
@@ -938,6 +938,9 @@ void SX126xCalibrate( CalibrationParams_t calibParam );
 /*!
  * \brief Calibrates the Image rejection depending of the frequency
  *
+ * \remark \ref SX126xSetRfFrequency runs it again only when the new frequency
+ *         falls in a different calibration band
+ *
  * \param [in]  freq    The operating frequency
  */
 void SX126xCalibrateImage( uint32_t freq );
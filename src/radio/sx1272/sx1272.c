@@ -49,6 +49,23 @@
  */
 #define RX_TX_BUFFER_SIZE                           256
 
+/*!
+ * \brief Register cache page size and number of pages ( FSK and LoRa )
+ */
+#define REG_CACHE_PAGE_SIZE                         0x80
+#define REG_CACHE_PAGES                             2
+#define REG_CACHE_PAGE_FSK                          0
+#define REG_CACHE_PAGE_LORA                         1
+
+/*!
+ * \brief Number of entries of the frequency to PLL steps conversion cache
+ *
+ * \remark Must be a power of 2
+ */
+#ifndef SX1272_PLL_STEP_CACHE_SIZE
+#define SX1272_PLL_STEP_CACHE_SIZE                   16
+#endif
+
 /*
  * Local types definition
  */
@@ -72,6 +89,58 @@ typedef struct
     uint8_t  RegValue;
 }FskBandwidth_t;
 
+/*!
+ * Register cache definition
+ *
+ * Addresses REG_RXCONFIG to REG_IRQFLAGS2 map to different registers in FSK
+ * and LoRa modes, hence one page per modem. Registers shared by both modems
+ * are kept in the FSK page.
+ */
+typedef struct
+{
+    uint8_t Value[REG_CACHE_PAGES * REG_CACHE_PAGE_SIZE];
+    uint8_t Valid[REG_CACHE_PAGES * REG_CACHE_PAGE_SIZE / 8];
+    /*!
+     * REG_OPMODE shadow. Tracked apart from the other registers as the radio
+     * updates the mode bits on its own ( Rx single, Tx and CAD completion )
+     */
+    uint8_t OpMode;
+    bool    OpModeValid;
+}RegCache_t;
+
+/*!
+ * Software emulated Rx duty cycle state. Each listen window is a LoRa single
+ * reception bounded by the symbol timeout. A preamble detected within the
+ * window holds the radio in reception until the end of the packet.
+ */
+typedef struct
+{
+    bool     IsRunning;
+    uint16_t RxSymbols;                             //!< Listen window duration [symbols]
+    uint32_t SleepTime;                             //!< Sleep duration between listen windows [ms]
+}RxDutyCycle_t;
+
+/*!
+ * Software emulated CAD duration. The hardware CAD listens for about one
+ * symbol, longer detections chain CAD operations until one of them detects
+ * activity or the requested number of symbols has been listened to.
+ */
+typedef struct
+{
+    uint8_t Symbols;                                //!< Requested CAD duration [symbols]
+    uint8_t Remaining;                              //!< CAD operations left in the current detection
+}Cad_t;
+
+/*!
+ * Frequency to PLL steps conversion cache entry. A zeroed entry is valid as
+ * 0 Hz converts to 0 PLL steps
+ */
+typedef struct
+{
+    uint32_t FreqInHz;
+    uint32_t PllSteps;
+}PllStepCacheEntry_t;
+
 
 /*
  * Private functions prototypes
@@ -107,6 +176,41 @@ static void SX1272ReadFifo( uint8_t *buffer, uint8_t size );
  */
 static void SX1272SetOpMode( uint8_t opMode );
 
+/*!
+ * \brief Gets the SX1272 REG_OPMODE register value
+ *
+ * \remark Returns the last written value when known. The mode bits may then
+ *         differ from the radio ones if it went back to standby on its own.
+ *
+ * \retval opMode Operating mode register value
+ */
+static uint8_t SX1272GetOpModeReg( void );
+
+/*!
+ * \brief Invalidates the whole register cache
+ *
+ * \remark Must be called each time the radio registers are reset to their
+ *         default values
+ */
+static void SX1272RegCacheInvalidate( void );
+
+/*!
+ * \brief Gets the register cache index for the given address
+ *
+ * \param [IN] addr Register address
+ * \retval index    Cache index, -1 when the register must be read from the radio
+ */
+static int16_t SX1272RegCacheIndex( uint32_t addr );
+
+/*!
+ * \brief Updates the register cache after a registers write
+ *
+ * \param [IN] addr   First register address
+ * \param [IN] buffer Written values
+ * \param [IN] size   Number of registers written
+ */
+static void SX1272RegCacheUpdate( uint32_t addr, uint8_t *buffer, uint8_t size );
+
 /*!
  * \brief Get frequency in Hertz for a given number of PLL steps
  *
@@ -213,6 +317,16 @@ static void SX1272OnDio4Irq( void* context );
  */
 static void SX1272OnTimeoutIrq( void* context );
 
+/*!
+ * \brief Rx duty cycle timer callback. Starts the next listen window
+ */
+static void SX1272OnRxDutyCycleTimerIrq( void* context );
+
+/*!
+ * \brief Stops the software emulated Rx duty cycle, if running
+ */
+static void SX1272RxDutyCycleStop( void );
+
 /*
  * Private global constants
  */
@@ -272,6 +386,16 @@ static RadioEvents_t *RadioEvents;
  */
 static uint8_t RxTxBuffer[RX_TX_BUFFER_SIZE];
 
+/*!
+ * Write-through cache of the non-volatile configuration registers
+ */
+static RegCache_t RegCache;
+
+/*!
+ * Direct-mapped cache of the last converted frequencies
+ */
+static PllStepCacheEntry_t PllStepCache[SX1272_PLL_STEP_CACHE_SIZE];
+
 /*
  * Public global variables
  */
@@ -294,6 +418,22 @@ DioIrqHandler *DioIrq[] = { SX1272OnDio0Irq, SX1272OnDio1Irq,
 TimerEvent_t TxTimeoutTimer;
 TimerEvent_t RxTimeoutTimer;
 TimerEvent_t RxTimeoutSyncWord;
+TimerEvent_t RxDutyCycleTimer;
+
+/*!
+ * Rx duty cycle emulation state
+ */
+static RxDutyCycle_t RxDutyCycle;
+
+/*!
+ * CAD emulation state
+ */
+static Cad_t Cad = { .Symbols = 1, .Remaining = 0 };
+
+/*!
+ * Time of the last radio interrupt [ms]
+ */
+static uint32_t IrqTime = 0;
 
 /*
  * Radio driver functions implementation
@@ -309,8 +449,10 @@ void SX1272Init( RadioEvents_t *events )
     TimerInit( &TxTimeoutTimer, SX1272OnTimeoutIrq );
     TimerInit( &RxTimeoutTimer, SX1272OnTimeoutIrq );
     TimerInit( &RxTimeoutSyncWord, SX1272OnTimeoutIrq );
+    TimerInit( &RxDutyCycleTimer, SX1272OnRxDutyCycleTimerIrq );
 
     SX1272Reset( );
+    SX1272RegCacheInvalidate( );
 
     SX1272SetOpMode( RF_OPMODE_SLEEP );
 
@@ -770,7 +912,7 @@ void SX1272Send( uint8_t *buffer, uint8_t size )
             SX1272Write( REG_LR_FIFOADDRPTR, 0 );
 
             // FIFO operations can not take place in Sleep mode
-            if( ( SX1272Read( REG_OPMODE ) & ~RF_OPMODE_MASK ) == RF_OPMODE_SLEEP )
+            if( ( SX1272GetOpModeReg( ) & ~RF_OPMODE_MASK ) == RF_OPMODE_SLEEP )
             {
                 SX1272SetStby( );
                 DelayMs( 1 );
@@ -790,6 +932,7 @@ void SX1272SetSleep( void )
     TimerStop( &RxTimeoutTimer );
     TimerStop( &TxTimeoutTimer );
     TimerStop( &RxTimeoutSyncWord );
+    SX1272RxDutyCycleStop( );
 
     SX1272SetOpMode( RF_OPMODE_SLEEP );
 
@@ -804,6 +947,7 @@ void SX1272SetStby( void )
     TimerStop( &RxTimeoutTimer );
     TimerStop( &TxTimeoutTimer );
     TimerStop( &RxTimeoutSyncWord );
+    SX1272RxDutyCycleStop( );
 
     SX1272SetOpMode( RF_OPMODE_STANDBY );
     SX1272.Settings.State = RF_IDLE;
@@ -813,6 +957,7 @@ void SX1272SetRx( uint32_t timeout )
 {
     bool rxContinuous = false;
     TimerStop( &TxTimeoutTimer );
+    SX1272RxDutyCycleStop( );
 
     switch( SX1272.Settings.Modem )
     {
@@ -932,6 +1077,7 @@ void SX1272SetRx( uint32_t timeout )
 static void SX1272SetTx( uint32_t timeout )
 {
     TimerStop( &RxTimeoutTimer );
+    SX1272RxDutyCycleStop( );
 
     TimerSetValue( &TxTimeoutTimer, timeout );
 
@@ -995,6 +1141,8 @@ static void SX1272SetTx( uint32_t timeout )
 
 void SX1272StartCad( void )
 {
+    SX1272RxDutyCycleStop( );
+
     switch( SX1272.Settings.Modem )
     {
     case MODEM_FSK:
@@ -1004,6 +1152,8 @@ void SX1272StartCad( void )
         break;
     case MODEM_LORA:
         {
+            Cad.Remaining = Cad.Symbols;
+
             SX1272Write( REG_LR_IRQFLAGSMASK, RFLR_IRQFLAGS_RXTIMEOUT |
                                         RFLR_IRQFLAGS_RXDONE |
                                         RFLR_IRQFLAGS_PAYLOADCRCERROR |
@@ -1026,8 +1176,66 @@ void SX1272StartCad( void )
     }
 }
 
+void SX1272SetCadParams( uint8_t symbols )
+{
+    Cad.Symbols = MAX( symbols, 1 );
+}
+
+uint32_t SX1272GetIrqTime( void )
+{
+    return IrqTime;
+}
+
+void SX1272SetRxDutyCycle( uint32_t rxTime, uint32_t sleepTime )
+{
+    if( SX1272.Settings.Modem != MODEM_LORA )
+    {
+        // No emulation for the FSK modem, fall back to continuous reception
+        SX1272SetRx( 0 );
+        return;
+    }
+
+    // Convert the durations from 15.625 us steps
+    uint32_t symbolTimeInUs = ( ( uint32_t )1 << SX1272.Settings.LoRa.Datarate ) * 1000000 /
+                              SX1272GetLoRaBandwidthInHz( SX1272.Settings.LoRa.Bandwidth );
+    uint32_t rxSymbols = ( ( ( rxTime * 125 ) >> 3 ) + symbolTimeInUs - 1 ) / symbolTimeInUs;
+
+    // The symbol timeout register is 10 bits wide
+    rxSymbols = MIN( MAX( rxSymbols, 1 ), 0x3FF );
+
+    RxDutyCycle.RxSymbols = ( uint16_t )rxSymbols;
+    RxDutyCycle.SleepTime = MAX( ( sleepTime * 125 ) / 8000, 1 );
+
+    // The duty cycled reception ends after the first received packet
+    SX1272.Settings.LoRa.RxContinuous = false;
+
+    SX1272Write( REG_LR_MODEMCONFIG2, ( SX1272Read( REG_LR_MODEMCONFIG2 ) & RFLR_MODEMCONFIG2_SYMBTIMEOUTMSB_MASK ) |
+                                    ( ( rxSymbols >> 8 ) & ~RFLR_MODEMCONFIG2_SYMBTIMEOUTMSB_MASK ) );
+    SX1272Write( REG_LR_SYMBTIMEOUTLSB, ( uint8_t )( rxSymbols & 0xFF ) );
+
+    SX1272SetRx( 0 );
+    RxDutyCycle.IsRunning = true;
+}
+
+static void SX1272RxDutyCycleStop( void )
+{
+    TimerStop( &RxDutyCycleTimer );
+    RxDutyCycle.IsRunning = false;
+}
+
+static void SX1272OnRxDutyCycleTimerIrq( void* context )
+{
+    if( RxDutyCycle.IsRunning == true )
+    {
+        SX1272SetRx( 0 );
+        RxDutyCycle.IsRunning = true;
+    }
+}
+
 void SX1272SetTxContinuousWave( uint32_t freq, int8_t power, uint16_t time )
 {
+    SX1272RxDutyCycleStop( );
+
     uint32_t timeout = ( uint32_t )time * 1000;
 
     SX1272SetChannel( freq );
@@ -1096,12 +1304,12 @@ static void SX1272SetOpMode( uint8_t opMode )
         SX1272SetAntSwLowPower( false );
         SX1272SetAntSw( opMode );
     }
-    SX1272Write( REG_OPMODE, ( SX1272Read( REG_OPMODE ) & RF_OPMODE_MASK ) | opMode );
+    SX1272Write( REG_OPMODE, ( SX1272GetOpModeReg( ) & RF_OPMODE_MASK ) | opMode );
 }
 
 void SX1272SetModem( RadioModems_t modem )
 {
-    if( ( SX1272Read( REG_OPMODE ) & RFLR_OPMODE_LONGRANGEMODE_ON ) != 0 )
+    if( ( SX1272GetOpModeReg( ) & RFLR_OPMODE_LONGRANGEMODE_ON ) != 0 )
     {
         SX1272.Settings.Modem = MODEM_LORA;
     }
@@ -1121,14 +1329,14 @@ void SX1272SetModem( RadioModems_t modem )
     default:
     case MODEM_FSK:
         SX1272SetOpMode( RF_OPMODE_SLEEP );
-        SX1272Write( REG_OPMODE, ( SX1272Read( REG_OPMODE ) & RFLR_OPMODE_LONGRANGEMODE_MASK ) | RFLR_OPMODE_LONGRANGEMODE_OFF );
+        SX1272Write( REG_OPMODE, ( SX1272GetOpModeReg( ) & RFLR_OPMODE_LONGRANGEMODE_MASK ) | RFLR_OPMODE_LONGRANGEMODE_OFF );
 
         SX1272Write( REG_DIOMAPPING1, 0x00 );
         SX1272Write( REG_DIOMAPPING2, 0x30 ); // DIO5=ModeReady
         break;
     case MODEM_LORA:
         SX1272SetOpMode( RF_OPMODE_SLEEP );
-        SX1272Write( REG_OPMODE, ( SX1272Read( REG_OPMODE ) & RFLR_OPMODE_LONGRANGEMODE_MASK ) | RFLR_OPMODE_LONGRANGEMODE_ON );
+        SX1272Write( REG_OPMODE, ( SX1272GetOpModeReg( ) & RFLR_OPMODE_LONGRANGEMODE_MASK ) | RFLR_OPMODE_LONGRANGEMODE_ON );
 
         SX1272Write( REG_DIOMAPPING1, 0x00 );
         SX1272Write( REG_DIOMAPPING2, 0x00 );
@@ -1144,43 +1352,191 @@ void SX1272Write( uint32_t addr, uint8_t data )
 uint8_t SX1272Read( uint32_t addr )
 {
     uint8_t data;
+    int16_t index = SX1272RegCacheIndex( addr );
+
+    if( ( index >= 0 ) && ( ( RegCache.Valid[index >> 3] & ( 1 << ( index & 0x07 ) ) ) != 0 ) )
+    {
+        return RegCache.Value[index];
+    }
+
     SX1272ReadBuffer( addr, &data, 1 );
+
+    if( index >= 0 )
+    {
+        RegCache.Value[index] = data;
+        RegCache.Valid[index >> 3] |= 1 << ( index & 0x07 );
+    }
+    else if( addr == REG_OPMODE )
+    {
+        RegCache.OpMode = data;
+        RegCache.OpModeValid = true;
+    }
     return data;
 }
 
 void SX1272WriteBuffer( uint32_t addr, uint8_t *buffer, uint8_t size )
 {
-    uint8_t i;
-
     //NSS = 0;
     GpioWrite( &SX1272.Spi.Nss, 0 );
 
     SpiInOut( &SX1272.Spi, addr | 0x80 );
-    for( i = 0; i < size; i++ )
-    {
-        SpiInOut( &SX1272.Spi, buffer[i] );
-    }
+    SpiTransfer( &SX1272.Spi, buffer, NULL, size );
 
     //NSS = 1;
     GpioWrite( &SX1272.Spi.Nss, 1 );
+
+    SX1272RegCacheUpdate( addr, buffer, size );
 }
 
 void SX1272ReadBuffer( uint32_t addr, uint8_t *buffer, uint8_t size )
 {
-    uint8_t i;
-
     //NSS = 0;
     GpioWrite( &SX1272.Spi.Nss, 0 );
 
     SpiInOut( &SX1272.Spi, addr & 0x7F );
+    SpiTransfer( &SX1272.Spi, NULL, buffer, size );
 
-    for( i = 0; i < size; i++ )
+    //NSS = 1;
+    GpioWrite( &SX1272.Spi.Nss, 1 );
+}
+
+static uint8_t SX1272GetOpModeReg( void )
+{
+    if( RegCache.OpModeValid == true )
     {
-        buffer[i] = SpiInOut( &SX1272.Spi, 0 );
+        return RegCache.OpMode;
     }
+    return SX1272Read( REG_OPMODE );
+}
 
-    //NSS = 1;
-    GpioWrite( &SX1272.Spi.Nss, 1 );
+static void SX1272RegCacheInvalidate( void )
+{
+    memset1( ( uint8_t* )&RegCache, 0, sizeof( RegCache_t ) );
+}
+
+static int16_t SX1272RegCacheIndex( uint32_t addr )
+{
+    if( ( addr < REG_RXCONFIG ) || ( addr >= REG_DIOMAPPING1 ) )
+    {
+        switch( addr )
+        {
+            case REG_FRFMSB:
+            case REG_FRFMID:
+            case REG_FRFLSB:
+            case REG_PACONFIG:
+            case REG_PARAMP:
+            case REG_OCP:
+            case REG_DIOMAPPING1:
+            case REG_DIOMAPPING2:
+            case REG_AGCREF:
+            case REG_AGCTHRESH1:
+            case REG_AGCTHRESH2:
+            case REG_AGCTHRESH3:
+            case REG_PLLHOP:
+            case REG_TCXO:
+            case REG_PADAC:
+            case REG_PLL:
+                return ( REG_CACHE_PAGE_FSK * REG_CACHE_PAGE_SIZE ) + addr;
+            default:
+                return -1;
+        }
+    }
+
+    // Modem dependent registers. The page in use is only known once REG_OPMODE is.
+    if( RegCache.OpModeValid == false )
+    {
+        return -1;
+    }
+    if( ( RegCache.OpMode & ( RFLR_OPMODE_LONGRANGEMODE_ON | RFLR_OPMODE_ACCESSSHAREDREG_ENABLE ) ) == RFLR_OPMODE_LONGRANGEMODE_ON )
+    {
+        switch( addr )
+        {
+            case REG_LR_FIFOTXBASEADDR:
+            case REG_LR_FIFORXBASEADDR:
+            case REG_LR_IRQFLAGSMASK:
+            case REG_LR_MODEMCONFIG1:
+            case REG_LR_MODEMCONFIG2:
+            case REG_LR_SYMBTIMEOUTLSB:
+            case REG_LR_PREAMBLEMSB:
+            case REG_LR_PREAMBLELSB:
+            case REG_LR_PAYLOADMAXLENGTH:
+            case REG_LR_HOPPERIOD:
+            case REG_LR_DETECTOPTIMIZE:
+            case REG_LR_INVERTIQ:
+            case REG_LR_DETECTIONTHRESHOLD:
+            case REG_LR_SYNCWORD:
+            case REG_LR_INVERTIQ2:
+                return ( REG_CACHE_PAGE_LORA * REG_CACHE_PAGE_SIZE ) + addr;
+            default:
+                return -1;
+        }
+    }
+    switch( addr )
+    {
+        case REG_RSSICONFIG:
+        case REG_RSSICOLLISION:
+        case REG_RSSITHRESH:
+        case REG_RXBW:
+        case REG_AFCBW:
+        case REG_OOKPEAK:
+        case REG_OOKFIX:
+        case REG_OOKAVG:
+        case REG_PREAMBLEDETECT:
+        case REG_RXTIMEOUT1:
+        case REG_RXTIMEOUT2:
+        case REG_RXTIMEOUT3:
+        case REG_RXDELAY:
+        case REG_PREAMBLEMSB:
+        case REG_PREAMBLELSB:
+        case REG_SYNCCONFIG:
+        case REG_SYNCVALUE1:
+        case REG_SYNCVALUE2:
+        case REG_SYNCVALUE3:
+        case REG_SYNCVALUE4:
+        case REG_SYNCVALUE5:
+        case REG_SYNCVALUE6:
+        case REG_SYNCVALUE7:
+        case REG_SYNCVALUE8:
+        case REG_PACKETCONFIG1:
+        case REG_PACKETCONFIG2:
+        case REG_PAYLOADLENGTH:
+        case REG_NODEADRS:
+        case REG_BROADCASTADRS:
+        case REG_FIFOTHRESH:
+        case REG_SEQCONFIG2:
+        case REG_TIMERRESOL:
+        case REG_TIMER1COEF:
+        case REG_TIMER2COEF:
+        case REG_LOWBAT:
+            return ( REG_CACHE_PAGE_FSK * REG_CACHE_PAGE_SIZE ) + addr;
+        default:
+            return -1;
+    }
+}
+
+static void SX1272RegCacheUpdate( uint32_t addr, uint8_t *buffer, uint8_t size )
+{
+    int16_t index;
+
+    if( addr == REG_FIFO )
+    {
+        return;
+    }
+    for( uint8_t i = 0; i < size; i++ )
+    {
+        if( ( addr + i ) == REG_OPMODE )
+        {
+            RegCache.OpMode = buffer[i];
+            RegCache.OpModeValid = true;
+            continue;
+        }
+        index = SX1272RegCacheIndex( addr + i );
+        if( index >= 0 )
+        {
+            RegCache.Value[index] = buffer[i];
+            RegCache.Valid[index >> 3] |= 1 << ( index & 0x07 );
+        }
+    }
 }
 
 static void SX1272WriteFifo( uint8_t *buffer, uint8_t size )
@@ -1249,18 +1605,28 @@ static uint32_t SX1272ConvertPllStepToFreqInHz( uint32_t pllSteps )
 
 static uint32_t SX1272ConvertFreqInHzToPllStep( uint32_t freqInHz )
 {
+    // Channel plans use a small set of frequencies. Index on 16 kHz granularity
+    // so that adjacent channels land in different entries.
+    PllStepCacheEntry_t *entry = &PllStepCache[( freqInHz >> 14 ) & ( SX1272_PLL_STEP_CACHE_SIZE - 1 )];
     uint32_t stepsInt;
     uint32_t stepsFrac;
 
+    if( entry->FreqInHz == freqInHz )
+    {
+        return entry->PllSteps;
+    }
+
     // pllSteps = freqInHz / (SX1272_XTAL_FREQ / 2^19 )
     // Get integer and fractional parts of the frequency computed with a PLL step scaled value
     stepsInt = freqInHz / SX1272_PLL_STEP_SCALED;
     stepsFrac = freqInHz - ( stepsInt * SX1272_PLL_STEP_SCALED );
     
     // Apply the scaling factor to retrieve a frequency in Hz (+ ceiling)
-    return ( stepsInt << SX1272_PLL_STEP_SHIFT_AMOUNT ) + 
-           ( ( ( stepsFrac << SX1272_PLL_STEP_SHIFT_AMOUNT ) + ( SX1272_PLL_STEP_SCALED >> 1 ) ) /
-             SX1272_PLL_STEP_SCALED );
+    entry->FreqInHz = freqInHz;
+    entry->PllSteps = ( stepsInt << SX1272_PLL_STEP_SHIFT_AMOUNT ) + 
+                      ( ( ( stepsFrac << SX1272_PLL_STEP_SHIFT_AMOUNT ) + ( SX1272_PLL_STEP_SCALED >> 1 ) ) /
+                        SX1272_PLL_STEP_SCALED );
+    return entry->PllSteps;
 }
 
 static uint8_t GetFskBandwidthRegValue( uint32_t bw )
@@ -1380,6 +1746,8 @@ static uint32_t SX1272GetLoRaTimeOnAirNumerator( uint32_t bandwidth,
 
 static void SX1272OnTimeoutIrq( void* context )
 {
+    IrqTime = TimerGetCurrentTime( );
+
     switch( SX1272.Settings.State )
     {
     case RF_RX_RUNNING:
@@ -1425,6 +1793,7 @@ static void SX1272OnTimeoutIrq( void* context )
 
         // Reset the radio
         SX1272Reset( );
+        SX1272RegCacheInvalidate( );
 
         // Initialize radio default values
         SX1272SetOpMode( RF_OPMODE_SLEEP );
@@ -1455,6 +1824,8 @@ static void SX1272OnDio0Irq( void* context )
 {
     volatile uint8_t irqFlags = 0;
 
+    IrqTime = TimerGetCurrentTime( );
+
     switch( SX1272.Settings.State )
     {
         case RF_RX_RUNNING:
@@ -1625,6 +1996,8 @@ static void SX1272OnDio0Irq( void* context )
 
 static void SX1272OnDio1Irq( void* context )
 {
+    IrqTime = TimerGetCurrentTime( );
+
     switch( SX1272.Settings.State )
     {
         case RF_RX_RUNNING:
@@ -1692,6 +2065,16 @@ static void SX1272OnDio1Irq( void* context )
                 // Clear Irq
                 SX1272Write( REG_LR_IRQFLAGS, RFLR_IRQFLAGS_RXTIMEOUT );
 
+                if( RxDutyCycle.IsRunning == true )
+                {
+                    // No preamble within the listen window. Sleep until the next one
+                    SX1272SetOpMode( RF_OPMODE_SLEEP );
+                    SX1272SetBoardTcxo( false );
+                    TimerSetValue( &RxDutyCycleTimer, RxDutyCycle.SleepTime );
+                    TimerStart( &RxDutyCycleTimer );
+                    break;
+                }
+
                 SX1272.Settings.State = RF_IDLE;
                 if( ( RadioEvents != NULL ) && ( RadioEvents->RxTimeout != NULL ) )
                 {
@@ -1830,6 +2213,13 @@ static void SX1272OnDio3Irq( void* context )
         {
             // Clear Irq
             SX1272Write( REG_LR_IRQFLAGS, RFLR_IRQFLAGS_CADDONE );
+            if( Cad.Remaining > 1 )
+            {
+                // Keep listening until the requested CAD duration is reached
+                Cad.Remaining--;
+                SX1272SetOpMode( RFLR_OPMODE_CAD );
+                break;
+            }
             if( ( RadioEvents != NULL ) && ( RadioEvents->CadDone != NULL ) )
             {
                 RadioEvents->CadDone( false );
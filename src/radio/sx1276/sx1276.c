@@ -51,6 +51,54 @@
  */
 #define RX_TX_BUFFER_SIZE                           256
 
+/*!
+ * \brief Register cache page size and number of pages ( FSK and LoRa )
+ */
+#define REG_CACHE_PAGE_SIZE                         0x80
+#define REG_CACHE_PAGES                             2
+#define REG_CACHE_PAGE_FSK                          0
+#define REG_CACHE_PAGE_LORA                         1
+
+/*!
+ * \brief Number of entries of the frequency to PLL steps conversion cache
+ *
+ * \remark Must be a power of 2
+ */
+#ifndef SX1276_PLL_STEP_CACHE_SIZE
+#define SX1276_PLL_STEP_CACHE_SIZE                   16
+#endif
+
+/*!
+ * \brief FSK FIFO size
+ */
+#define FSK_FIFO_SIZE                               64
+
+/*!
+ * \brief Minimum FSK FIFO threshold
+ */
+#define FSK_FIFO_THRESH_MIN                         8
+
+/*!
+ * \brief SPI clock frequency used to budget the FSK FIFO transfers [Hz]
+ */
+#ifndef SX1276_SPI_FREQUENCY
+#define SX1276_SPI_FREQUENCY                        10000000
+#endif
+
+/*!
+ * \brief Worst case latency between a DIO edge and its handler [us]
+ */
+#ifndef SX1276_FIFO_IRQ_LATENCY
+#define SX1276_FIFO_IRQ_LATENCY                     100
+#endif
+
+/*!
+ * \brief Maximum duration of a FSK FIFO transfer from an interrupt handler [us]
+ */
+#ifndef SX1276_FIFO_IRQ_MAX_TRANSFER_TIME
+#define SX1276_FIFO_IRQ_MAX_TRANSFER_TIME           200
+#endif
+
 /*
  * Local types definition
  */
@@ -74,6 +122,67 @@ typedef struct
     uint8_t  RegValue;
 }FskBandwidth_t;
 
+/*!
+ * Register cache definition
+ *
+ * Addresses REG_RXCONFIG to REG_IRQFLAGS2 map to different registers in FSK
+ * and LoRa modes, hence one page per modem. Registers shared by both modems
+ * are kept in the FSK page.
+ */
+typedef struct
+{
+    uint8_t Value[REG_CACHE_PAGES * REG_CACHE_PAGE_SIZE];
+    uint8_t Valid[REG_CACHE_PAGES * REG_CACHE_PAGE_SIZE / 8];
+    /*!
+     * REG_OPMODE shadow. Tracked apart from the other registers as the radio
+     * updates the mode bits on its own ( Rx single, Tx and CAD completion )
+     */
+    uint8_t OpMode;
+    bool    OpModeValid;
+}RegCache_t;
+
+/*!
+ * Software emulated Rx duty cycle state. Each listen window is a LoRa single
+ * reception bounded by the symbol timeout. A preamble detected within the
+ * window holds the radio in reception until the end of the packet.
+ */
+typedef struct
+{
+    bool     IsRunning;
+    uint16_t RxSymbols;                             //!< Listen window duration [symbols]
+    uint32_t SleepTime;                             //!< Sleep duration between listen windows [ms]
+}RxDutyCycle_t;
+
+/*!
+ * Software emulated CAD duration. The hardware CAD listens for about one
+ * symbol, longer detections chain CAD operations until one of them detects
+ * activity or the requested number of symbols has been listened to.
+ */
+typedef struct
+{
+    uint8_t Symbols;                                //!< Requested CAD duration [symbols]
+    uint8_t Remaining;                              //!< CAD operations left in the current detection
+}Cad_t;
+
+/*!
+ * FSK FIFO thresholds used to stream packets longer than the FIFO
+ */
+typedef struct
+{
+    uint8_t RxThresh;                               //!< FifoLevel threshold while receiving
+    uint8_t TxThresh;                               //!< FifoLevel threshold while transmitting
+}FskFifo_t;
+
+/*!
+ * Frequency to PLL steps conversion cache entry. A zeroed entry is valid as
+ * 0 Hz converts to 0 PLL steps
+ */
+typedef struct
+{
+    uint32_t FreqInHz;
+    uint32_t PllSteps;
+}PllStepCacheEntry_t;
+
 
 /*
  * Private functions prototypes
@@ -115,6 +224,41 @@ static void SX1276ReadFifo( uint8_t *buffer, uint8_t size );
  */
 static void SX1276SetOpMode( uint8_t opMode );
 
+/*!
+ * \brief Gets the SX1276 REG_OPMODE register value
+ *
+ * \remark Returns the last written value when known. The mode bits may then
+ *         differ from the radio ones if it went back to standby on its own.
+ *
+ * \retval opMode Operating mode register value
+ */
+static uint8_t SX1276GetOpModeReg( void );
+
+/*!
+ * \brief Invalidates the whole register cache
+ *
+ * \remark Must be called each time the radio registers are reset to their
+ *         default values
+ */
+static void SX1276RegCacheInvalidate( void );
+
+/*!
+ * \brief Gets the register cache index for the given address
+ *
+ * \param [IN] addr Register address
+ * \retval index    Cache index, -1 when the register must be read from the radio
+ */
+static int16_t SX1276RegCacheIndex( uint32_t addr );
+
+/*!
+ * \brief Updates the register cache after a registers write
+ *
+ * \param [IN] addr   First register address
+ * \param [IN] buffer Written values
+ * \param [IN] size   Number of registers written
+ */
+static void SX1276RegCacheUpdate( uint32_t addr, uint8_t *buffer, uint8_t size );
+
 /*!
  * \brief Get frequency in Hertz for a given number of PLL steps
  *
@@ -221,6 +365,38 @@ static void SX1276OnDio4Irq( void* context );
  */
 static void SX1276OnTimeoutIrq( void* context );
 
+/*!
+ * \brief Rx duty cycle timer callback. Starts the next listen window
+ */
+static void SX1276OnRxDutyCycleTimerIrq( void* context );
+
+/*!
+ * \brief Stops the software emulated Rx duty cycle, if running
+ */
+static void SX1276RxDutyCycleStop( void );
+
+/*!
+ * \brief Computes the FSK FIFO thresholds for the given bitrate
+ *
+ * The receive threshold is the highest one leaving room in the FIFO for the
+ * bytes received during the interrupt latency and the FIFO read. The transmit
+ * threshold is the lowest one holding enough bytes to cover the interrupt
+ * latency and the FIFO write. Both keep the transfers under
+ * SX1276_FIFO_IRQ_MAX_TRANSFER_TIME.
+ *
+ * \param [IN] datarate FSK bitrate [bps]
+ */
+static void SX1276ComputeFskFifoThresh( uint32_t datarate );
+
+/*!
+ * \brief Reads the next chunk of the FSK packet off the FIFO in a single SPI
+ *        burst. The length byte of variable length packets is read in the
+ *        same burst when the packet starts.
+ *
+ * \param [IN] maxSize Maximum number of payload bytes to read
+ */
+static void SX1276ReadFskFifoChunk( uint16_t maxSize );
+
 /*
  * Private global constants
  */
@@ -281,6 +457,16 @@ static RadioEvents_t *RadioEvents;
  */
 static uint8_t RxTxBuffer[RX_TX_BUFFER_SIZE];
 
+/*!
+ * Write-through cache of the non-volatile configuration registers
+ */
+static RegCache_t RegCache;
+
+/*!
+ * Direct-mapped cache of the last converted frequencies
+ */
+static PllStepCacheEntry_t PllStepCache[SX1276_PLL_STEP_CACHE_SIZE];
+
 /*
  * Public global variables
  */
@@ -303,6 +489,27 @@ DioIrqHandler *DioIrq[] = { SX1276OnDio0Irq, SX1276OnDio1Irq,
 TimerEvent_t TxTimeoutTimer;
 TimerEvent_t RxTimeoutTimer;
 TimerEvent_t RxTimeoutSyncWord;
+TimerEvent_t RxDutyCycleTimer;
+
+/*!
+ * Rx duty cycle emulation state
+ */
+static RxDutyCycle_t RxDutyCycle;
+
+/*!
+ * CAD emulation state
+ */
+static Cad_t Cad = { .Symbols = 1, .Remaining = 0 };
+
+/*!
+ * FSK FIFO thresholds. Defaults match RADIO_INIT_REGISTERS_VALUE
+ */
+static FskFifo_t FskFifo = { .RxThresh = 31, .TxThresh = 31 };
+
+/*!
+ * Time of the last radio interrupt [ms]
+ */
+static uint32_t IrqTime = 0;
 
 /*
  * Radio driver functions implementation
@@ -318,8 +525,10 @@ void SX1276Init( RadioEvents_t *events )
     TimerInit( &TxTimeoutTimer, SX1276OnTimeoutIrq );
     TimerInit( &RxTimeoutTimer, SX1276OnTimeoutIrq );
     TimerInit( &RxTimeoutSyncWord, SX1276OnTimeoutIrq );
+    TimerInit( &RxDutyCycleTimer, SX1276OnRxDutyCycleTimerIrq );
 
     SX1276Reset( );
+    SX1276RegCacheInvalidate( );
 
     RxChainCalibration( );
 
@@ -490,6 +699,7 @@ void SX1276SetRxConfig( RadioModems_t modem, uint32_t bandwidth,
             SX1276.Settings.Fsk.RxContinuous = rxContinuous;
             SX1276.Settings.Fsk.PreambleLen = preambleLen;
             SX1276.Settings.Fsk.RxSingleTimeout = ( uint32_t )symbTimeout * 8000UL / datarate;
+            SX1276ComputeFskFifoThresh( datarate );
 
             uint32_t bitRate = ( uint32_t )( SX1276_XTAL_FREQ / datarate );
             SX1276Write( REG_BITRATEMSB, ( uint8_t )( bitRate >> 8 ) );
@@ -656,6 +866,7 @@ void SX1276SetTxConfig( RadioModems_t modem, int8_t power, uint32_t fdev,
             SX1276.Settings.Fsk.Datarate = datarate;
             SX1276.Settings.Fsk.PreambleLen = preambleLen;
             SX1276.Settings.Fsk.FixLen = fixLen;
+            SX1276ComputeFskFifoThresh( datarate );
             SX1276.Settings.Fsk.CrcOn = crcOn;
             SX1276.Settings.Fsk.IqInverted = iqInverted;
             SX1276.Settings.Fsk.TxTimeout = timeout;
@@ -817,19 +1028,26 @@ void SX1276Send( uint8_t *buffer, uint8_t size )
                 SX1276Write( REG_PAYLOADLENGTH, size );
             }
 
-            if( ( size > 0 ) && ( size <= 64 ) )
+            // Fill the FIFO, the remaining bytes are written by the FifoLevel
+            // interrupt in chunks refilling it up to FSK_FIFO_SIZE - 1 bytes
+            uint8_t firstChunkSize = FSK_FIFO_SIZE - 1;
+            if( SX1276.Settings.Fsk.FixLen == false )
             {
-                SX1276.Settings.FskPacketHandler.ChunkSize = size;
+                firstChunkSize--;
             }
-            else
+            if( size > firstChunkSize )
             {
                 memcpy1( RxTxBuffer, buffer, size );
-                SX1276.Settings.FskPacketHandler.ChunkSize = 32;
             }
+            else
+            {
+                firstChunkSize = size;
+            }
+            SX1276.Settings.FskPacketHandler.ChunkSize = FSK_FIFO_SIZE - 1 - FskFifo.TxThresh;
 
             // Write payload buffer
-            SX1276WriteFifo( buffer, SX1276.Settings.FskPacketHandler.ChunkSize );
-            SX1276.Settings.FskPacketHandler.NbBytes += SX1276.Settings.FskPacketHandler.ChunkSize;
+            SX1276WriteFifo( buffer, firstChunkSize );
+            SX1276.Settings.FskPacketHandler.NbBytes += firstChunkSize;
             txTimeout = SX1276.Settings.Fsk.TxTimeout;
         }
         break;
@@ -856,7 +1074,7 @@ void SX1276Send( uint8_t *buffer, uint8_t size )
             SX1276Write( REG_LR_FIFOADDRPTR, 0 );
 
             // FIFO operations can not take place in Sleep mode
-            if( ( SX1276Read( REG_OPMODE ) & ~RF_OPMODE_MASK ) == RF_OPMODE_SLEEP )
+            if( ( SX1276GetOpModeReg( ) & ~RF_OPMODE_MASK ) == RF_OPMODE_SLEEP )
             {
                 SX1276SetStby( );
                 DelayMs( 1 );
@@ -876,6 +1094,7 @@ void SX1276SetSleep( void )
     TimerStop( &RxTimeoutTimer );
     TimerStop( &TxTimeoutTimer );
     TimerStop( &RxTimeoutSyncWord );
+    SX1276RxDutyCycleStop( );
 
     SX1276SetOpMode( RF_OPMODE_SLEEP );
 
@@ -890,6 +1109,7 @@ void SX1276SetStby( void )
     TimerStop( &RxTimeoutTimer );
     TimerStop( &TxTimeoutTimer );
     TimerStop( &RxTimeoutSyncWord );
+    SX1276RxDutyCycleStop( );
 
     SX1276SetOpMode( RF_OPMODE_STANDBY );
     SX1276.Settings.State = RF_IDLE;
@@ -899,6 +1119,7 @@ void SX1276SetRx( uint32_t timeout )
 {
     bool rxContinuous = false;
     TimerStop( &TxTimeoutTimer );
+    SX1276RxDutyCycleStop( );
 
     switch( SX1276.Settings.Modem )
     {
@@ -924,7 +1145,8 @@ void SX1276SetRx( uint32_t timeout )
                                                                             RF_DIOMAPPING2_DIO4_11 |
                                                                             RF_DIOMAPPING2_MAP_PREAMBLEDETECT );
 
-            SX1276.Settings.FskPacketHandler.FifoThresh = SX1276Read( REG_FIFOTHRESH ) & 0x3F;
+            SX1276Write( REG_FIFOTHRESH, ( SX1276Read( REG_FIFOTHRESH ) & RF_FIFOTHRESH_FIFOTHRESHOLD_MASK ) | FskFifo.RxThresh );
+            SX1276.Settings.FskPacketHandler.FifoThresh = FskFifo.RxThresh;
 
             SX1276Write( REG_RXCONFIG, RF_RXCONFIG_AFCAUTO_ON | RF_RXCONFIG_AGCAUTO_ON | RF_RXCONFIG_RXTRIGER_PREAMBLEDETECT );
 
@@ -1065,6 +1287,7 @@ void SX1276SetRx( uint32_t timeout )
 static void SX1276SetTx( uint32_t timeout )
 {
     TimerStop( &RxTimeoutTimer );
+    SX1276RxDutyCycleStop( );
 
     TimerSetValue( &TxTimeoutTimer, timeout );
 
@@ -1084,7 +1307,8 @@ static void SX1276SetTx( uint32_t timeout )
 
             SX1276Write( REG_DIOMAPPING2, ( SX1276Read( REG_DIOMAPPING2 ) & RF_DIOMAPPING2_DIO4_MASK &
                                                                             RF_DIOMAPPING2_MAP_MASK ) );
-            SX1276.Settings.FskPacketHandler.FifoThresh = SX1276Read( REG_FIFOTHRESH ) & 0x3F;
+            SX1276Write( REG_FIFOTHRESH, ( SX1276Read( REG_FIFOTHRESH ) & RF_FIFOTHRESH_FIFOTHRESHOLD_MASK ) | FskFifo.TxThresh );
+            SX1276.Settings.FskPacketHandler.FifoThresh = FskFifo.TxThresh;
         }
         break;
     case MODEM_LORA:
@@ -1128,6 +1352,8 @@ static void SX1276SetTx( uint32_t timeout )
 
 void SX1276StartCad( void )
 {
+    SX1276RxDutyCycleStop( );
+
     switch( SX1276.Settings.Modem )
     {
     case MODEM_FSK:
@@ -1137,6 +1363,8 @@ void SX1276StartCad( void )
         break;
     case MODEM_LORA:
         {
+            Cad.Remaining = Cad.Symbols;
+
             SX1276Write( REG_LR_IRQFLAGSMASK, RFLR_IRQFLAGS_RXTIMEOUT |
                                         RFLR_IRQFLAGS_RXDONE |
                                         RFLR_IRQFLAGS_PAYLOADCRCERROR |
@@ -1159,8 +1387,66 @@ void SX1276StartCad( void )
     }
 }
 
+void SX1276SetCadParams( uint8_t symbols )
+{
+    Cad.Symbols = MAX( symbols, 1 );
+}
+
+uint32_t SX1276GetIrqTime( void )
+{
+    return IrqTime;
+}
+
+void SX1276SetRxDutyCycle( uint32_t rxTime, uint32_t sleepTime )
+{
+    if( SX1276.Settings.Modem != MODEM_LORA )
+    {
+        // No emulation for the FSK modem, fall back to continuous reception
+        SX1276SetRx( 0 );
+        return;
+    }
+
+    // Convert the durations from 15.625 us steps
+    uint32_t symbolTimeInUs = ( ( uint32_t )1 << SX1276.Settings.LoRa.Datarate ) * 1000000 /
+                              SX1276GetLoRaBandwidthInHz( SX1276.Settings.LoRa.Bandwidth );
+    uint32_t rxSymbols = ( ( ( rxTime * 125 ) >> 3 ) + symbolTimeInUs - 1 ) / symbolTimeInUs;
+
+    // The symbol timeout register is 10 bits wide
+    rxSymbols = MIN( MAX( rxSymbols, 1 ), 0x3FF );
+
+    RxDutyCycle.RxSymbols = ( uint16_t )rxSymbols;
+    RxDutyCycle.SleepTime = MAX( ( sleepTime * 125 ) / 8000, 1 );
+
+    // The duty cycled reception ends after the first received packet
+    SX1276.Settings.LoRa.RxContinuous = false;
+
+    SX1276Write( REG_LR_MODEMCONFIG2, ( SX1276Read( REG_LR_MODEMCONFIG2 ) & RFLR_MODEMCONFIG2_SYMBTIMEOUTMSB_MASK ) |
+                                    ( ( rxSymbols >> 8 ) & ~RFLR_MODEMCONFIG2_SYMBTIMEOUTMSB_MASK ) );
+    SX1276Write( REG_LR_SYMBTIMEOUTLSB, ( uint8_t )( rxSymbols & 0xFF ) );
+
+    SX1276SetRx( 0 );
+    RxDutyCycle.IsRunning = true;
+}
+
+static void SX1276RxDutyCycleStop( void )
+{
+    TimerStop( &RxDutyCycleTimer );
+    RxDutyCycle.IsRunning = false;
+}
+
+static void SX1276OnRxDutyCycleTimerIrq( void* context )
+{
+    if( RxDutyCycle.IsRunning == true )
+    {
+        SX1276SetRx( 0 );
+        RxDutyCycle.IsRunning = true;
+    }
+}
+
 void SX1276SetTxContinuousWave( uint32_t freq, int8_t power, uint16_t time )
 {
+    SX1276RxDutyCycleStop( );
+
     uint32_t timeout = ( uint32_t )time * 1000;
 
     SX1276SetChannel( freq );
@@ -1236,12 +1522,12 @@ static void SX1276SetOpMode( uint8_t opMode )
         SX1276SetAntSwLowPower( false );
         SX1276SetAntSw( opMode );
     }
-    SX1276Write( REG_OPMODE, ( SX1276Read( REG_OPMODE ) & RF_OPMODE_MASK ) | opMode );
+    SX1276Write( REG_OPMODE, ( SX1276GetOpModeReg( ) & RF_OPMODE_MASK ) | opMode );
 }
 
 void SX1276SetModem( RadioModems_t modem )
 {
-    if( ( SX1276Read( REG_OPMODE ) & RFLR_OPMODE_LONGRANGEMODE_ON ) != 0 )
+    if( ( SX1276GetOpModeReg( ) & RFLR_OPMODE_LONGRANGEMODE_ON ) != 0 )
     {
         SX1276.Settings.Modem = MODEM_LORA;
     }
@@ -1261,14 +1547,14 @@ void SX1276SetModem( RadioModems_t modem )
     default:
     case MODEM_FSK:
         SX1276SetOpMode( RF_OPMODE_SLEEP );
-        SX1276Write( REG_OPMODE, ( SX1276Read( REG_OPMODE ) & RFLR_OPMODE_LONGRANGEMODE_MASK ) | RFLR_OPMODE_LONGRANGEMODE_OFF );
+        SX1276Write( REG_OPMODE, ( SX1276GetOpModeReg( ) & RFLR_OPMODE_LONGRANGEMODE_MASK ) | RFLR_OPMODE_LONGRANGEMODE_OFF );
 
         SX1276Write( REG_DIOMAPPING1, 0x00 );
         SX1276Write( REG_DIOMAPPING2, 0x30 ); // DIO5=ModeReady
         break;
     case MODEM_LORA:
         SX1276SetOpMode( RF_OPMODE_SLEEP );
-        SX1276Write( REG_OPMODE, ( SX1276Read( REG_OPMODE ) & RFLR_OPMODE_LONGRANGEMODE_MASK ) | RFLR_OPMODE_LONGRANGEMODE_ON );
+        SX1276Write( REG_OPMODE, ( SX1276GetOpModeReg( ) & RFLR_OPMODE_LONGRANGEMODE_MASK ) | RFLR_OPMODE_LONGRANGEMODE_ON );
 
         SX1276Write( REG_DIOMAPPING1, 0x00 );
         SX1276Write( REG_DIOMAPPING2, 0x00 );
@@ -1284,43 +1570,260 @@ void SX1276Write( uint32_t addr, uint8_t data )
 uint8_t SX1276Read( uint32_t addr )
 {
     uint8_t data;
+    int16_t index = SX1276RegCacheIndex( addr );
+
+    if( ( index >= 0 ) && ( ( RegCache.Valid[index >> 3] & ( 1 << ( index & 0x07 ) ) ) != 0 ) )
+    {
+        return RegCache.Value[index];
+    }
+
     SX1276ReadBuffer( addr, &data, 1 );
+
+    if( index >= 0 )
+    {
+        RegCache.Value[index] = data;
+        RegCache.Valid[index >> 3] |= 1 << ( index & 0x07 );
+    }
+    else if( addr == REG_OPMODE )
+    {
+        RegCache.OpMode = data;
+        RegCache.OpModeValid = true;
+    }
     return data;
 }
 
 void SX1276WriteBuffer( uint32_t addr, uint8_t *buffer, uint8_t size )
 {
-    uint8_t i;
-
     //NSS = 0;
     GpioWrite( &SX1276.Spi.Nss, 0 );
 
     SpiInOut( &SX1276.Spi, addr | 0x80 );
-    for( i = 0; i < size; i++ )
-    {
-        SpiInOut( &SX1276.Spi, buffer[i] );
-    }
+    SpiTransfer( &SX1276.Spi, buffer, NULL, size );
 
     //NSS = 1;
     GpioWrite( &SX1276.Spi.Nss, 1 );
+
+    SX1276RegCacheUpdate( addr, buffer, size );
 }
 
 void SX1276ReadBuffer( uint32_t addr, uint8_t *buffer, uint8_t size )
 {
-    uint8_t i;
-
     //NSS = 0;
     GpioWrite( &SX1276.Spi.Nss, 0 );
 
     SpiInOut( &SX1276.Spi, addr & 0x7F );
+    SpiTransfer( &SX1276.Spi, NULL, buffer, size );
+
+    //NSS = 1;
+    GpioWrite( &SX1276.Spi.Nss, 1 );
+}
+
+static uint8_t SX1276GetOpModeReg( void )
+{
+    if( RegCache.OpModeValid == true )
+    {
+        return RegCache.OpMode;
+    }
+    return SX1276Read( REG_OPMODE );
+}
+
+static void SX1276RegCacheInvalidate( void )
+{
+    memset1( ( uint8_t* )&RegCache, 0, sizeof( RegCache_t ) );
+}
+
+static int16_t SX1276RegCacheIndex( uint32_t addr )
+{
+    if( ( addr < REG_RXCONFIG ) || ( addr >= REG_DIOMAPPING1 ) )
+    {
+        switch( addr )
+        {
+            case REG_FRFMSB:
+            case REG_FRFMID:
+            case REG_FRFLSB:
+            case REG_PACONFIG:
+            case REG_PARAMP:
+            case REG_OCP:
+            case REG_DIOMAPPING1:
+            case REG_DIOMAPPING2:
+            case REG_PLLHOP:
+            case REG_TCXO:
+            case REG_PADAC:
+            case REG_AGCREF:
+            case REG_AGCTHRESH1:
+            case REG_AGCTHRESH2:
+            case REG_AGCTHRESH3:
+            case REG_PLL:
+                return ( REG_CACHE_PAGE_FSK * REG_CACHE_PAGE_SIZE ) + addr;
+            default:
+                return -1;
+        }
+    }
+
+    // Modem dependent registers. The page in use is only known once REG_OPMODE is.
+    if( RegCache.OpModeValid == false )
+    {
+        return -1;
+    }
+    if( ( RegCache.OpMode & ( RFLR_OPMODE_LONGRANGEMODE_ON | RFLR_OPMODE_ACCESSSHAREDREG_ENABLE ) ) == RFLR_OPMODE_LONGRANGEMODE_ON )
+    {
+        switch( addr )
+        {
+            case REG_LR_FIFOTXBASEADDR:
+            case REG_LR_FIFORXBASEADDR:
+            case REG_LR_IRQFLAGSMASK:
+            case REG_LR_MODEMCONFIG1:
+            case REG_LR_MODEMCONFIG2:
+            case REG_LR_SYMBTIMEOUTLSB:
+            case REG_LR_PREAMBLEMSB:
+            case REG_LR_PREAMBLELSB:
+            case REG_LR_PAYLOADMAXLENGTH:
+            case REG_LR_HOPPERIOD:
+            case REG_LR_MODEMCONFIG3:
+            case REG_LR_IFFREQ1:
+            case REG_LR_IFFREQ2:
+            case REG_LR_DETECTOPTIMIZE:
+            case REG_LR_INVERTIQ:
+            case REG_LR_HIGHBWOPTIMIZE1:
+            case REG_LR_DETECTIONTHRESHOLD:
+            case REG_LR_SYNCWORD:
+            case REG_LR_HIGHBWOPTIMIZE2:
+            case REG_LR_INVERTIQ2:
+                return ( REG_CACHE_PAGE_LORA * REG_CACHE_PAGE_SIZE ) + addr;
+            default:
+                return -1;
+        }
+    }
+    switch( addr )
+    {
+        case REG_RSSICONFIG:
+        case REG_RSSICOLLISION:
+        case REG_RSSITHRESH:
+        case REG_RXBW:
+        case REG_AFCBW:
+        case REG_OOKPEAK:
+        case REG_OOKFIX:
+        case REG_OOKAVG:
+        case REG_PREAMBLEDETECT:
+        case REG_RXTIMEOUT1:
+        case REG_RXTIMEOUT2:
+        case REG_RXTIMEOUT3:
+        case REG_RXDELAY:
+        case REG_PREAMBLEMSB:
+        case REG_PREAMBLELSB:
+        case REG_SYNCCONFIG:
+        case REG_SYNCVALUE1:
+        case REG_SYNCVALUE2:
+        case REG_SYNCVALUE3:
+        case REG_SYNCVALUE4:
+        case REG_SYNCVALUE5:
+        case REG_SYNCVALUE6:
+        case REG_SYNCVALUE7:
+        case REG_SYNCVALUE8:
+        case REG_PACKETCONFIG1:
+        case REG_PACKETCONFIG2:
+        case REG_PAYLOADLENGTH:
+        case REG_NODEADRS:
+        case REG_BROADCASTADRS:
+        case REG_FIFOTHRESH:
+        case REG_SEQCONFIG2:
+        case REG_TIMERRESOL:
+        case REG_TIMER1COEF:
+        case REG_TIMER2COEF:
+        case REG_LOWBAT:
+            return ( REG_CACHE_PAGE_FSK * REG_CACHE_PAGE_SIZE ) + addr;
+        default:
+            return -1;
+    }
+}
+
+static void SX1276RegCacheUpdate( uint32_t addr, uint8_t *buffer, uint8_t size )
+{
+    int16_t index;
+
+    if( addr == REG_FIFO )
+    {
+        return;
+    }
+    for( uint8_t i = 0; i < size; i++ )
+    {
+        if( ( addr + i ) == REG_OPMODE )
+        {
+            RegCache.OpMode = buffer[i];
+            RegCache.OpModeValid = true;
+            continue;
+        }
+        index = SX1276RegCacheIndex( addr + i );
+        if( index >= 0 )
+        {
+            RegCache.Value[index] = buffer[i];
+            RegCache.Valid[index >> 3] |= 1 << ( index & 0x07 );
+        }
+    }
+}
+
+static void SX1276ReadFskFifoChunk( uint16_t maxSize )
+{
+    uint16_t size = 0;
+
+    if( ( SX1276.Settings.FskPacketHandler.Size == 0 ) && ( SX1276.Settings.FskPacketHandler.NbBytes == 0 ) &&
+        ( SX1276.Settings.Fsk.FixLen == true ) )
+    {
+        SX1276.Settings.FskPacketHandler.Size = SX1276Read( REG_PAYLOADLENGTH );
+    }
+
+    //NSS = 0;
+    GpioWrite( &SX1276.Spi.Nss, 0 );
 
-    for( i = 0; i < size; i++ )
+    SpiInOut( &SX1276.Spi, REG_FIFO & 0x7F );
+    if( ( SX1276.Settings.FskPacketHandler.Size == 0 ) && ( SX1276.Settings.FskPacketHandler.NbBytes == 0 ) &&
+        ( SX1276.Settings.Fsk.FixLen == false ) )
     {
-        buffer[i] = SpiInOut( &SX1276.Spi, 0 );
+        // Variable length packet, the first FIFO byte is the length
+        SX1276.Settings.FskPacketHandler.Size = SpiInOut( &SX1276.Spi, 0 );
     }
+    size = MIN( SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes, maxSize );
+    SpiTransfer( &SX1276.Spi, NULL, RxTxBuffer + SX1276.Settings.FskPacketHandler.NbBytes, size );
 
     //NSS = 1;
     GpioWrite( &SX1276.Spi.Nss, 1 );
+
+    SX1276.Settings.FskPacketHandler.NbBytes += size;
+}
+
+static void SX1276ComputeFskFifoThresh( uint32_t datarate )
+{
+    // Durations in ns. 8e9 does not fit 32 bits, hence the division by 2
+    uint32_t byteTime = ( 4000000000UL / datarate ) << 1;
+    uint32_t spiByteTime = ( 4000000000UL / SX1276_SPI_FREQUENCY ) << 1;
+    uint32_t transferTime = 0;
+    uint8_t thresh = 0;
+
+    // Rx: FifoLevel fires with RxThresh + 1 bytes in the FIFO, RxThresh - 1
+    // bytes are read while new ones keep coming in
+    for( thresh = FSK_FIFO_SIZE - 1; thresh > FSK_FIFO_THRESH_MIN; thresh-- )
+    {
+        transferTime = ( thresh - 1 ) * spiByteTime;
+        if( ( transferTime <= ( SX1276_FIFO_IRQ_MAX_TRANSFER_TIME * 1000UL ) ) &&
+            ( ( thresh + 1 + ( SX1276_FIFO_IRQ_LATENCY * 1000UL + transferTime + byteTime - 1 ) / byteTime ) < FSK_FIFO_SIZE ) )
+        {
+            break;
+        }
+    }
+    FskFifo.RxThresh = thresh;
+
+    // Tx: FifoLevel falls with TxThresh bytes in the FIFO, which must last
+    // until FSK_FIFO_SIZE - 1 - TxThresh bytes are written
+    for( thresh = FSK_FIFO_THRESH_MIN; thresh < ( FSK_FIFO_SIZE - 1 - FSK_FIFO_THRESH_MIN ); thresh++ )
+    {
+        transferTime = ( FSK_FIFO_SIZE - 1 - thresh ) * spiByteTime;
+        if( ( transferTime <= ( SX1276_FIFO_IRQ_MAX_TRANSFER_TIME * 1000UL ) ) &&
+            ( ( ( SX1276_FIFO_IRQ_LATENCY * 1000UL + transferTime + byteTime - 1 ) / byteTime ) <= thresh ) )
+        {
+            break;
+        }
+    }
+    FskFifo.TxThresh = thresh;
 }
 
 static void SX1276WriteFifo( uint8_t *buffer, uint8_t size )
@@ -1389,18 +1892,28 @@ static uint32_t SX1276ConvertPllStepToFreqInHz( uint32_t pllSteps )
 
 static uint32_t SX1276ConvertFreqInHzToPllStep( uint32_t freqInHz )
 {
+    // Channel plans use a small set of frequencies. Index on 16 kHz granularity
+    // so that adjacent channels land in different entries.
+    PllStepCacheEntry_t *entry = &PllStepCache[( freqInHz >> 14 ) & ( SX1276_PLL_STEP_CACHE_SIZE - 1 )];
     uint32_t stepsInt;
     uint32_t stepsFrac;
 
+    if( entry->FreqInHz == freqInHz )
+    {
+        return entry->PllSteps;
+    }
+
     // pllSteps = freqInHz / (SX1276_XTAL_FREQ / 2^19 )
     // Get integer and fractional parts of the frequency computed with a PLL step scaled value
     stepsInt = freqInHz / SX1276_PLL_STEP_SCALED;
     stepsFrac = freqInHz - ( stepsInt * SX1276_PLL_STEP_SCALED );
     
     // Apply the scaling factor to retrieve a frequency in Hz (+ ceiling)
-    return ( stepsInt << SX1276_PLL_STEP_SHIFT_AMOUNT ) + 
-           ( ( ( stepsFrac << SX1276_PLL_STEP_SHIFT_AMOUNT ) + ( SX1276_PLL_STEP_SCALED >> 1 ) ) /
-             SX1276_PLL_STEP_SCALED );
+    entry->FreqInHz = freqInHz;
+    entry->PllSteps = ( stepsInt << SX1276_PLL_STEP_SHIFT_AMOUNT ) + 
+                      ( ( ( stepsFrac << SX1276_PLL_STEP_SHIFT_AMOUNT ) + ( SX1276_PLL_STEP_SCALED >> 1 ) ) /
+                        SX1276_PLL_STEP_SCALED );
+    return entry->PllSteps;
 }
 
 static uint8_t GetFskBandwidthRegValue( uint32_t bw )
@@ -1520,6 +2033,8 @@ static uint32_t SX1276GetLoRaTimeOnAirNumerator( uint32_t bandwidth,
 
 static void SX1276OnTimeoutIrq( void* context )
 {
+    IrqTime = TimerGetCurrentTime( );
+
     switch( SX1276.Settings.State )
     {
     case RF_RX_RUNNING:
@@ -1565,6 +2080,7 @@ static void SX1276OnTimeoutIrq( void* context )
 
         // Reset the radio
         SX1276Reset( );
+        SX1276RegCacheInvalidate( );
 
         // Calibrate Rx chain
         RxChainCalibration( );
@@ -1598,6 +2114,8 @@ static void SX1276OnDio0Irq( void* context )
 {
     volatile uint8_t irqFlags = 0;
 
+    IrqTime = TimerGetCurrentTime( );
+
     switch( SX1276.Settings.State )
     {
         case RF_RX_RUNNING:
@@ -1642,25 +2160,8 @@ static void SX1276OnDio0Irq( void* context )
                     }
                 }
 
-                // Read received packet size
-                if( ( SX1276.Settings.FskPacketHandler.Size == 0 ) && ( SX1276.Settings.FskPacketHandler.NbBytes == 0 ) )
-                {
-                    if( SX1276.Settings.Fsk.FixLen == false )
-                    {
-                        SX1276ReadFifo( ( uint8_t* )&SX1276.Settings.FskPacketHandler.Size, 1 );
-                    }
-                    else
-                    {
-                        SX1276.Settings.FskPacketHandler.Size = SX1276Read( REG_PAYLOADLENGTH );
-                    }
-                    SX1276ReadFifo( RxTxBuffer + SX1276.Settings.FskPacketHandler.NbBytes, SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes );
-                    SX1276.Settings.FskPacketHandler.NbBytes += ( SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes );
-                }
-                else
-                {
-                    SX1276ReadFifo( RxTxBuffer + SX1276.Settings.FskPacketHandler.NbBytes, SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes );
-                    SX1276.Settings.FskPacketHandler.NbBytes += ( SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes );
-                }
+                // Read the received packet size and the remaining payload
+                SX1276ReadFskFifoChunk( RX_TX_BUFFER_SIZE );
 
                 TimerStop( &RxTimeoutTimer );
 
@@ -1783,6 +2284,8 @@ static void SX1276OnDio0Irq( void* context )
 
 static void SX1276OnDio1Irq( void* context )
 {
+    IrqTime = TimerGetCurrentTime( );
+
     switch( SX1276.Settings.State )
     {
         case RF_RX_RUNNING:
@@ -1803,19 +2306,6 @@ static void SX1276OnDio1Irq( void* context )
                 TimerStop( &RxTimeoutSyncWord );
 
                 // FifoLevel interrupt
-                // Read received packet size
-                if( ( SX1276.Settings.FskPacketHandler.Size == 0 ) && ( SX1276.Settings.FskPacketHandler.NbBytes == 0 ) )
-                {
-                    if( SX1276.Settings.Fsk.FixLen == false )
-                    {
-                        SX1276ReadFifo( ( uint8_t* )&SX1276.Settings.FskPacketHandler.Size, 1 );
-                    }
-                    else
-                    {
-                        SX1276.Settings.FskPacketHandler.Size = SX1276Read( REG_PAYLOADLENGTH );
-                    }
-                }
-
                 // ERRATA 3.1 - PayloadReady Set for 31.25ns if FIFO is Empty
                 //
                 //              When FifoLevel interrupt is used to offload the
@@ -1823,16 +2313,7 @@ static void SX1276OnDio1Irq( void* context )
                 //              PayloadReady  and FifoLevel interrupts, and
                 //              read only (FifoThreshold-1) bytes off the FIFO
                 //              when FifoLevel fires
-                if( ( SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes ) >= SX1276.Settings.FskPacketHandler.FifoThresh )
-                {
-                    SX1276ReadFifo( ( RxTxBuffer + SX1276.Settings.FskPacketHandler.NbBytes ), SX1276.Settings.FskPacketHandler.FifoThresh - 1 );
-                    SX1276.Settings.FskPacketHandler.NbBytes += SX1276.Settings.FskPacketHandler.FifoThresh - 1;
-                }
-                else
-                {
-                    SX1276ReadFifo( ( RxTxBuffer + SX1276.Settings.FskPacketHandler.NbBytes ), SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes );
-                    SX1276.Settings.FskPacketHandler.NbBytes += ( SX1276.Settings.FskPacketHandler.Size - SX1276.Settings.FskPacketHandler.NbBytes );
-                }
+                SX1276ReadFskFifoChunk( SX1276.Settings.FskPacketHandler.FifoThresh - 1 );
                 break;
             case MODEM_LORA:
                 // Check RxTimeout DIO1 pin state
@@ -1851,6 +2332,16 @@ static void SX1276OnDio1Irq( void* context )
                 // Clear Irq
                 SX1276Write( REG_LR_IRQFLAGS, RFLR_IRQFLAGS_RXTIMEOUT );
 
+                if( RxDutyCycle.IsRunning == true )
+                {
+                    // No preamble within the listen window. Sleep until the next one
+                    SX1276SetOpMode( RF_OPMODE_SLEEP );
+                    SX1276SetBoardTcxo( false );
+                    TimerSetValue( &RxDutyCycleTimer, RxDutyCycle.SleepTime );
+                    TimerStart( &RxDutyCycleTimer );
+                    break;
+                }
+
                 SX1276.Settings.State = RF_IDLE;
                 if( ( RadioEvents != NULL ) && ( RadioEvents->RxTimeout != NULL ) )
                 {
@@ -1989,6 +2480,13 @@ static void SX1276OnDio3Irq( void* context )
         {
             // Clear Irq
             SX1276Write( REG_LR_IRQFLAGS, RFLR_IRQFLAGS_CADDONE );
+            if( Cad.Remaining > 1 )
+            {
+                // Keep listening until the requested CAD duration is reached
+                Cad.Remaining--;
+                SX1276SetOpMode( RFLR_OPMODE_CAD );
+                break;
+            }
             if( ( RadioEvents != NULL ) && ( RadioEvents->CadDone != NULL ) )
             {
                 RadioEvents->CadDone( false );
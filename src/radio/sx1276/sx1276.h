@@ -366,6 +366,37 @@ void SX1276SetStby( void );
  */
 void SX1276SetRx( uint32_t timeout );
 
+/*!
+ * \brief Sets the radio in duty cycled reception mode
+ *
+ * \remark Software emulation of the SX126x Rx duty cycle mode. The radio
+ *         listens for rxTime, then sleeps for sleepTime and so on until a
+ *         packet is received. Only the LoRa modem is supported, the FSK
+ *         modem falls back to continuous reception.
+ *
+ * \param [IN] rxTime    Listen window duration [15.625 us steps]
+ * \param [IN] sleepTime Sleep duration between listen windows [15.625 us steps]
+ */
+void SX1276SetRxDutyCycle( uint32_t rxTime, uint32_t sleepTime );
+
+/*!
+ * \brief Sets the channel activity detection duration
+ *
+ * \remark The hardware CAD listens for about one symbol. Longer durations
+ *         are emulated by chaining CAD operations, CadDone is signaled on
+ *         the first detection or once all of them are done.
+ *
+ * \param [IN] symbols Number of symbols to listen for
+ */
+void SX1276SetCadParams( uint8_t symbols );
+
+/*!
+ * \brief Gets the time of the last radio interrupt
+ *
+ * \retval time Time captured in the DIO and timeout interrupt handlers [ms]
+ */
+uint32_t SX1276GetIrqTime( void );
+
 /*!
  * \brief Start a Channel Activity Detection
  */
@@ -398,6 +429,9 @@ void SX1276Write( uint32_t addr, uint8_t data );
 /*!
  * \brief Reads the radio register at the specified address
  *
+ * \remark Non-volatile configuration registers are served from a write-through
+ *         cache, invalidated on radio reset, without any SPI access
+ *
  * \param [IN]: addr Register address
  * \retval data Register value
  */
@@ -102,6 +102,20 @@ void SpiFrequency( Spi_t *obj, uint32_t hz );
  */
 uint16_t SpiInOut( Spi_t *obj, uint16_t outData );
 
+/*!
+ * \brief Sends and receives a block of bytes
+ *
+ * \remark The bytes are clocked back to back without any per byte function
+ *         call. 0x00 bytes are sent when txBuffer is NULL and the received
+ *         bytes are discarded when rxBuffer is NULL.
+ *
+ * \param [IN]  obj      SPI object
+ * \param [IN]  txBuffer Bytes to be sent. May be NULL
+ * \param [OUT] rxBuffer Received bytes. May be NULL
+ * \param [IN]  size     Number of bytes to transfer
+ */
+void SpiTransfer( Spi_t *obj, const uint8_t *txBuffer, uint8_t *rxBuffer, uint16_t size );
+
 #ifdef __cplusplus
 }
 #endif